@@ -5,6 +5,14 @@
 #include <vector>
 #include <cstdlib>
 #include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <string>
+#include <unordered_map>
+#include <tuple>
 
 struct RefCounted
 {
@@ -29,107 +37,643 @@ struct RefCounted
 		}
 	}
 
+	bool IsShared() const
+	{
+		return _refCount > 1;
+	}
+
 	virtual ~RefCounted() { }
 };
 
 struct ArrayBufferAllocator: v8::ArrayBuffer::Allocator
 {
+	std::atomic<int64_t> LiveBytes;
+	std::atomic<int64_t> PeakBytes;
+	std::atomic<int64_t> PoolHits;
+	std::atomic<int64_t> PoolMisses;
+
+	ArrayBufferAllocator()
+	{
+		LiveBytes = 0;
+		PeakBytes = 0;
+		PoolHits = 0;
+		PoolMisses = 0;
+	}
+
+	virtual void* Allocate(size_t length)
+	{
+		return Allocated(calloc(length, 1), length);
+	}
+
+	virtual void* AllocateUninitialized(size_t length)
+	{
+		return Allocated(malloc(length), length);
+	}
+
+	virtual void Free(void* data, size_t length)
+	{
+		Freed(data, length);
+		free(data);
+	}
+
+	void GetStatistics(JSArrayBufferAllocatorStatistics* outStatistics) const
+	{
+		outStatistics->LiveBytes = LiveBytes;
+		outStatistics->PeakBytes = PeakBytes;
+		outStatistics->PoolHits = PoolHits;
+		outStatistics->PoolMisses = PoolMisses;
+	}
+
+protected:
+	void* Allocated(void* data, size_t length)
+	{
+		if (data != nullptr)
+		{
+			int64_t liveBytes = LiveBytes += length;
+			int64_t peakBytes = PeakBytes;
+			while (liveBytes > peakBytes && !PeakBytes.compare_exchange_weak(peakBytes, liveBytes)) { }
+		}
+		return data;
+	}
+
+	void Freed(void* data, size_t length)
+	{
+		if (data != nullptr)
+			LiveBytes -= length;
+	}
+};
+
+// Recycles the backing stores of small ArrayBuffers. Sizes up to MaxPooledSize
+// are rounded up to a power of two size class, and freed blocks are kept on a
+// per-class free list (up to MaxPooledBytesPerClass) for reuse.
+struct PoolingArrayBufferAllocator: ArrayBufferAllocator
+{
+	static const size_t MinSizeClassShift = 4;
+	static const size_t NumSizeClasses = 13;
+	static const size_t MaxPooledSize = (size_t)1 << (MinSizeClassShift + NumSizeClasses - 1);
+	static const size_t MaxPooledBytesPerClass = 1024 * 1024;
+
+	std::mutex Mutex;
+	std::vector<void*> FreeLists[NumSizeClasses];
+
+	virtual ~PoolingArrayBufferAllocator()
+	{
+		for (auto& freeList : FreeLists)
+		{
+			for (auto data : freeList)
+				free(data);
+		}
+	}
+
 	virtual void* Allocate(size_t length)
 	{
-		return calloc(length, 1);
+		if (!IsPooled(length))
+			return ArrayBufferAllocator::Allocate(length);
+		auto data = Pop(length);
+		if (data != nullptr)
+			memset(data, 0, length);
+		return data;
 	}
 
 	virtual void* AllocateUninitialized(size_t length)
 	{
-		return malloc(length);
+		if (!IsPooled(length))
+			return ArrayBufferAllocator::AllocateUninitialized(length);
+		return Pop(length);
 	}
 
-	virtual void Free(void* data, size_t)
+	virtual void Free(void* data, size_t length)
 	{
+		if (data == nullptr || !IsPooled(length))
+		{
+			ArrayBufferAllocator::Free(data, length);
+			return;
+		}
+		Freed(data, length);
+		auto sizeClass = SizeClass(length);
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			auto& freeList = FreeLists[sizeClass];
+			if ((freeList.size() + 1) * SizeClassSize(sizeClass) <= MaxPooledBytesPerClass)
+			{
+				freeList.push_back(data);
+				return;
+			}
+		}
 		free(data);
 	}
+
+private:
+	static inline bool IsPooled(size_t length) { return length > 0 && length <= MaxPooledSize; }
+
+	static inline size_t SizeClass(size_t length)
+	{
+		size_t sizeClass = 0;
+		while (SizeClassSize(sizeClass) < length)
+			++sizeClass;
+		return sizeClass;
+	}
+
+	static inline size_t SizeClassSize(size_t sizeClass) { return (size_t)1 << (MinSizeClassShift + sizeClass); }
+
+	void* Pop(size_t length)
+	{
+		auto sizeClass = SizeClass(length);
+		void* data = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			auto& freeList = FreeLists[sizeClass];
+			if (!freeList.empty())
+			{
+				data = freeList.back();
+				freeList.pop_back();
+			}
+		}
+		if (data != nullptr)
+			++PoolHits;
+		else
+		{
+			++PoolMisses;
+			data = malloc(SizeClassSize(sizeClass));
+		}
+		return Allocated(data, length);
+	}
+};
+
+static ArrayBufferAllocator* NewArrayBufferAllocator(JSArrayBufferAllocatorType type)
+{
+	switch (type)
+	{
+		case JSArrayBufferAllocatorType::Pooled:
+			return new PoolingArrayBufferAllocator();
+		case JSArrayBufferAllocatorType::Malloc:
+		default:
+			return new ArrayBufferAllocator();
+	}
+}
+
+// Guarded by _platformMutex
+static std::mutex _platformMutex;
+static v8::Platform* _platform = nullptr;
+static JSPlatformOptions _platformOptions;
+static bool _platformShutDown = false;
+static int _liveIsolates = 0;
+
+// Returns whether this call did the initialization. Needs _platformMutex.
+static bool InitializeV8Locked(const JSPlatformOptions& options)
+{
+	if (_platform != nullptr || _platformShutDown)
+		return false;
+	v8::V8::InitializeICU();
+	_platform = v8::platform::CreateDefaultPlatform(options.WorkerThreads);
+	v8::V8::InitializePlatform(_platform);
+	v8::V8::Initialize();
+	_platformOptions = options;
+	return true;
+}
+
+// Initializes V8 if needed and counts an isolate about to be created, which
+// keeps ShutdownV8Simple away until ReleaseV8. Fails once V8 is shut down.
+// There is no lock-free fast path: the count has to change under the same
+// lock that ShutdownV8Simple checks it under.
+static bool AcquireV8()
+{
+	std::lock_guard<std::mutex> lock(_platformMutex);
+	if (_platformShutDown)
+		return false;
+	InitializeV8Locked(JSPlatformOptions{0});
+	++_liveIsolates;
+	return true;
+}
+
+static void ReleaseV8()
+{
+	std::lock_guard<std::mutex> lock(_platformMutex);
+	--_liveIsolates;
+}
+
+template<typename T>
+inline static T const* data_ptr(const std::vector<T>& v)
+{
+	return v.size() > 0
+		? &*v.begin()
+		: nullptr;
+}
+
+template<typename T>
+inline static T* data_ptr(std::vector<T>& v)
+{
+	return v.size() > 0
+		? &*v.begin()
+		: nullptr;
+}
+
+// A fixed-length array that keeps up to N elements on the stack, for argument
+// lists on hot paths that are almost always short
+template<typename T, int N = 8>
+struct SmallArray
+{
+	T Stack[N];
+	std::unique_ptr<T[]> Heap;
+	T* const Data;
+	const int Length;
+
+	explicit SmallArray(int length)
+		: Stack()
+		, Heap(length > N ? new T[length]() : nullptr)
+		, Data(length > N ? Heap.get() : Stack)
+		, Length(length)
+	{
+	}
+
+	SmallArray(const SmallArray&) = delete;
+	SmallArray& operator=(const SmallArray&) = delete;
+
+	inline T& operator[](int i) { return Data[i]; }
+	inline T* begin() const { return Data; }
+	inline T* end() const { return Data + Length; }
 };
 
-v8::Platform* _platform = nullptr;
+template<typename T, int N>
+inline static T* data_ptr(SmallArray<T, N>& v)
+{
+	return v.Length > 0
+		? v.Data
+		: nullptr;
+}
 
 // Using this and not plain v8::Persistents ensures that the references are
 // reset in the destructor.
 template<class T>
 using ResettingPersistent = v8::Persistent<T, v8::CopyablePersistentTraits<T>>;
 
+static JSIsolateOptions DefaultIsolateOptions(JSArrayBufferAllocatorType allocatorType)
+{
+	JSIsolateOptions options;
+	memset(&options, 0, sizeof(options));
+	options.AllocatorType = allocatorType;
+	options.HeapLimitPolicy = JSHeapLimitPolicy::Default;
+	return options;
+}
+
+static bool IsValid(const JSIsolateOptions& options)
+{
+	return options.MaxSemiSpaceSizeMB >= 0
+		&& options.MaxOldSpaceSizeMB >= 0
+		&& options.CodeRangeSizeMB >= 0
+		&& options.StackLimitKB >= 0
+		&& (options.HeapLimitPolicy == JSHeapLimitPolicy::Default
+			|| (options.HeapLimitPercent > 0 && options.HeapLimitPercent <= 100));
+}
+
+// An isolate together with what it uses for as long as it lives. Created
+// through New, which fails once V8 is shut down.
+struct JSIsolate : RefCounted
+{
+	const JSIsolateOptions Options;
+	std::unique_ptr<ArrayBufferAllocator> Allocator;
+	std::vector<char> SnapshotBlob;
+	v8::StartupData SnapshotData;
+	v8::Isolate* Isolate;
+	std::atomic<int64_t> HeapLimitTerminations;
+	// Only touched by the thread holding the isolate's lock
+	int RunningScripts;
+	bool HeapLimitTerminationPending;
+	// The context debug messages go to, set by SetJSDebugMessageHandler
+	JSContext* DebugContext;
+
+	JSIsolate(
+		const uint8_t* snapshot = nullptr,
+		int snapshotLength = 0,
+		const JSIsolateOptions& options = DefaultIsolateOptions(JSArrayBufferAllocatorType::Malloc))
+		: Options(options)
+		, Allocator(NewArrayBufferAllocator(options.AllocatorType))
+		, SnapshotBlob(snapshot, snapshot + snapshotLength)
+		, SnapshotData{nullptr, 0}
+		, HeapLimitTerminations(0)
+		, RunningScripts(0)
+		, HeapLimitTerminationPending(false)
+		, DebugContext(nullptr)
+	{
+
+		v8::Isolate::CreateParams createParams;
+		createParams.array_buffer_allocator = Allocator.get();
+		if (!SnapshotBlob.empty())
+		{
+			SnapshotData.data = &SnapshotBlob[0];
+			SnapshotData.raw_size = static_cast<int>(SnapshotBlob.size());
+			createParams.snapshot_blob = &SnapshotData;
+		}
+		if (options.MaxSemiSpaceSizeMB > 0)
+			createParams.constraints.set_max_semi_space_size(options.MaxSemiSpaceSizeMB);
+		if (options.MaxOldSpaceSizeMB > 0)
+			createParams.constraints.set_max_old_space_size(options.MaxOldSpaceSizeMB);
+		if (options.CodeRangeSizeMB > 0)
+			createParams.constraints.set_code_range_size(static_cast<size_t>(options.CodeRangeSizeMB));
+		Isolate = v8::Isolate::New(createParams);
+		Isolate->SetData(0, this);
+
+		if (options.HeapLimitPolicy == JSHeapLimitPolicy::TerminateExecution)
+			Isolate->AddGCEpilogueCallback(&CheckHeapLimit);
+	}
+
+	virtual ~JSIsolate() override
+	{
+		Isolate->Dispose();
+		Isolate = nullptr;
+		ReleaseV8();
+	}
+
+	static JSIsolate* New(
+		const uint8_t* snapshot = nullptr,
+		int snapshotLength = 0,
+		const JSIsolateOptions& options = DefaultIsolateOptions(JSArrayBufferAllocatorType::Malloc))
+	{
+		if (!AcquireV8())
+			return nullptr;
+		return new JSIsolate(snapshot, snapshotLength, options);
+	}
+
+	inline bool HasSnapshot() const { return !SnapshotBlob.empty(); }
+
+	static inline JSIsolate* From(v8::Isolate* isolate)
+	{
+		return static_cast<JSIsolate*>(isolate->GetData(0));
+	}
+
+	// V8 keeps the stack limit per thread, so this is called with the
+	// caller's frame each time a thread takes the isolate's lock
+	void SetStackLimitHere()
+	{
+		if (Options.StackLimitKB <= 0)
+			return;
+		// V8 wants the lowest address the stack may grow to
+		uint32_t here;
+		Isolate->SetStackLimit(
+			reinterpret_cast<uintptr_t>(&here) - static_cast<uintptr_t>(Options.StackLimitKB) * 1024);
+	}
+
+	// V8 5.5 has no near-heap-limit callback, so check after each GC. GCs
+	// outside script are left alone, since a pending termination would
+	// otherwise hit the next, unrelated script.
+	static void CheckHeapLimit(v8::Isolate* isolate, v8::GCType, v8::GCCallbackFlags)
+	{
+		auto self = From(isolate);
+		if (self->RunningScripts == 0)
+			return;
+		v8::HeapStatistics statistics;
+		isolate->GetHeapStatistics(&statistics);
+		if (statistics.used_heap_size() * 100 >= statistics.heap_size_limit() * static_cast<size_t>(self->Options.HeapLimitPercent)
+			&& !isolate->IsExecutionTerminating())
+		{
+			++self->HeapLimitTerminations;
+			self->HeapLimitTerminationPending = true;
+			isolate->TerminateExecution();
+		}
+	}
+};
+
+// Isolates that are handed out to contexts and taken back when the contexts
+// are released, so that creating a context doesn't have to create an isolate
+struct JSIsolatePool : RefCounted
+{
+	const int Size;
+	const std::vector<uint8_t> Snapshot;
+	const JSIsolateOptions Options;
+	std::mutex Mutex;
+	std::vector<JSIsolate*> Idle;
+	int64_t Hits;
+	int64_t Misses;
+
+	JSIsolatePool(int size, const uint8_t* snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType)
+		: Size(size)
+		, Snapshot(snapshot, snapshot + snapshotLength)
+		, Options(DefaultIsolateOptions(allocatorType))
+		, Hits(0)
+		, Misses(0)
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			auto isolate = NewIsolate();
+			if (isolate != nullptr)
+				Idle.push_back(isolate);
+		}
+	}
+
+	virtual ~JSIsolatePool() override
+	{
+		for (auto isolate : Idle)
+			isolate->Release();
+	}
+
+	JSIsolate* NewIsolate()
+	{
+		return JSIsolate::New(data_ptr(Snapshot), static_cast<int>(Snapshot.size()), Options);
+	}
+
+	JSIsolate* Checkout()
+	{
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			if (!Idle.empty())
+			{
+				++Hits;
+				auto isolate = Idle.back();
+				Idle.pop_back();
+				return isolate;
+			}
+			++Misses;
+		}
+		return NewIsolate();
+	}
+
+	// Called once the isolate's context is gone. An isolate someone else
+	// still holds, e.g. through CreateJSContextInIsolate, is left to them.
+	void Return(JSIsolate* isolate)
+	{
+		if (isolate->IsShared())
+		{
+			isolate->Release();
+			return;
+		}
+		{
+			// Collect what the old context left behind now, so that its
+			// weak callbacks don't run while the next context uses the
+			// isolate, and drop what else it set on the isolate
+			v8::Locker locker(isolate->Isolate);
+			v8::Isolate::Scope isolateScope(isolate->Isolate);
+			v8::Debug::SetMessageHandler(isolate->Isolate, nullptr);
+			isolate->DebugContext = nullptr;
+			isolate->Isolate->CancelTerminateExecution();
+			isolate->HeapLimitTerminationPending = false;
+			isolate->Isolate->ContextDisposedNotification();
+			isolate->Isolate->LowMemoryNotification();
+		}
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			if (static_cast<int>(Idle.size()) < Size)
+			{
+				Idle.push_back(isolate);
+				return;
+			}
+		}
+		isolate->Release();
+	}
+};
+
 struct JSContext : RefCounted
 {
 	const JSCallbackFinalizer CallbackFinalizer;
 	const JSExternalFinalizer ExternalFinalizer;
+	// The context owns one reference to Owner. Contexts from a pool hand the
+	// isolate back to Pool instead of releasing it.
+	JSIsolate* const Owner;
+	JSIsolatePool* const Pool;
 	v8::Isolate* Isolate;
 	ResettingPersistent<v8::Context> Handle;
 	JSDebugMessageHandler DebugMessageHandler;
 	void* DebugMessageHandlerData;
+	// Internalized property name keys, owned by the context. Only touched
+	// under the isolate's Locker.
+	std::unordered_map<std::u16string, JSString*> InternedStrings;
+	std::u16string InternKey;
 
 	JSContext(
 		JSCallbackFinalizer callbackFinalizer,
-		JSExternalFinalizer externalFinalizer)
-		: CallbackFinalizer(callbackFinalizer)
-		, ExternalFinalizer(externalFinalizer)
-		, DebugMessageHandler(nullptr)
-		, DebugMessageHandlerData(nullptr)
-	{
-		if (_platform == nullptr)
-		{
-			v8::V8::InitializeICU();
-			_platform = v8::platform::CreateDefaultPlatform();
-			v8::V8::InitializePlatform(_platform);
-			v8::V8::Initialize();
-		}
+		JSExternalFinalizer externalFinalizer,
+		JSIsolate* owner,
+		JSIsolatePool* pool = nullptr);
 
-		static ArrayBufferAllocator arrayBufferAllocator;
-		v8::Isolate::CreateParams createParams;
-		createParams.array_buffer_allocator = &arrayBufferAllocator;
-		Isolate = v8::Isolate::New(createParams);
+	virtual ~JSContext() override;
 
-		v8::Locker locker(Isolate);
-		v8::Isolate::Scope isolateScope(Isolate);
-		v8::HandleScope handleScope(Isolate);
+	inline v8::Local<v8::Context> LocalHandle() { return Handle.Get(Isolate); }
+	void ReleaseInternedStrings();
 
-		auto localContext = v8::Context::New(Isolate);
-		v8::Context::Scope contextScope(localContext);
+	// Each v8::Context points back at its JSContext, so that callbacks shared
+	// between the contexts of an isolate can tell which one they run in
+	static const int EmbedderDataIndex = 1;
 
-		Handle.Reset(Isolate, localContext);
+	// Null once the JSContext is gone
+	static inline JSContext* FromCurrent(v8::Isolate* isolate)
+	{
+		return static_cast<JSContext*>(
+			isolate->GetCurrentContext()->GetAlignedPointerFromEmbedderData(EmbedderDataIndex));
 	}
 
-	virtual ~JSContext() override
+	// For native callbacks: throws an Error into script instead of returning
+	// null, since a released JSContext can't wrap values
+	static JSContext* FromCurrentOrThrow(v8::Isolate* isolate)
 	{
-		auto oldData = DebugMessageHandlerData;
-		DebugMessageHandler = nullptr;
-		DebugMessageHandlerData = nullptr;
-		if (ExternalFinalizer != nullptr && oldData != nullptr)
-			ExternalFinalizer(oldData);
-		Handle.Reset();
+		auto context = FromCurrent(isolate);
+		if (context == nullptr)
+			isolate->ThrowException(v8::Exception::Error(
+				v8::String::NewFromUtf8(
+					isolate,
+					"Native callback called after its context was released",
+					v8::NewStringType::kNormal).ToLocalChecked()));
+		return context;
+	}
+};
 
-		Isolate->Dispose();
-		Isolate = nullptr;
+// A scope that is only constructed when asked to
+template<typename T>
+struct OptionalScope
+{
+	template<typename A>
+	OptionalScope(bool enter, A arg)
+		: Entered(enter)
+	{
+		if (enter)
+			new (&Storage) T(arg);
+	}
+	~OptionalScope()
+	{
+		if (Entered)
+			reinterpret_cast<T*>(&Storage)->~T();
 	}
+	OptionalScope(const OptionalScope&) = delete;
+	OptionalScope& operator=(const OptionalScope&) = delete;
 
-	inline v8::Local<v8::Context> LocalHandle() { return Handle.Get(Isolate); }
+	const bool Entered;
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+};
+
+// Entered by EnterJSContextScope and kept until the matching
+// ExitJSContextScope, on the thread that entered it.
+struct JSContextScope
+{
+	JSContext* const Context;
+	const bool TakesLock;
+	v8::Locker Locker;
+	v8::Isolate::Scope IsolateScope;
+	v8::HandleScope HandleScope;
+	v8::Context::Scope ContextScope;
+
+	JSContextScope(JSContext* context)
+		: Context(context)
+		, TakesLock(!v8::Locker::IsLocked(context->Isolate))
+		, Locker(context->Isolate)
+		, IsolateScope(context->Isolate)
+		, HandleScope(context->Isolate)
+		, ContextScope(context->LocalHandle())
+	{
+		if (TakesLock)
+			context->Owner->SetStackLimitHere();
+	}
 };
 
+static thread_local std::vector<JSContextScope*> _enteredScopes;
+
+static inline bool IsEntered(JSContext* context)
+{
+	return !_enteredScopes.empty() && _enteredScopes.back()->Context == context;
+}
+
 struct V8Scope
 {
-	V8Scope(v8::Isolate* isolate, const ResettingPersistent<v8::Context>& context)
-		: Locker(isolate)
-		, IsolateScope(isolate)
+	V8Scope(v8::Isolate* isolate, const ResettingPersistent<v8::Context>& context, bool entered = false)
+		: TakesLock(!entered && !v8::Locker::IsLocked(isolate))
+		, Locker(!entered, isolate)
+		, IsolateScope(!entered, isolate)
 		, HandleScope(isolate)
-		, ContextScope(context.Get(isolate))
+		, ContextScope(!entered, context.Get(isolate))
 	{
+		if (TakesLock)
+			JSIsolate::From(isolate)->SetStackLimitHere();
 	}
+	// Only opens a HandleScope when the context was entered with
+	// EnterJSContextScope on this thread
 	V8Scope(JSContext* context)
-		: V8Scope(context->Isolate, context->Handle)
+		: V8Scope(context->Isolate, context->Handle, IsEntered(context))
 	{
 	}
-	v8::Locker Locker;
-	v8::Isolate::Scope IsolateScope;
+	const bool TakesLock;
+	OptionalScope<v8::Locker> Locker;
+	OptionalScope<v8::Isolate::Scope> IsolateScope;
 	v8::HandleScope HandleScope;
-	v8::Context::Scope ContextScope;
+	OptionalScope<v8::Context::Scope> ContextScope;
+};
+
+// Marks script as running for the heap limit check. Leaving the outermost
+// one drops a heap limit termination that script did not get to see.
+struct RunningScript
+{
+	JSIsolate* const Isolate;
+	explicit RunningScript(JSIsolate* isolate)
+		: Isolate(isolate)
+	{
+		++Isolate->RunningScripts;
+	}
+	~RunningScript()
+	{
+		if (--Isolate->RunningScripts == 0 && Isolate->HeapLimitTerminationPending)
+		{
+			Isolate->HeapLimitTerminationPending = false;
+			Isolate->Isolate->CancelTerminateExecution();
+		}
+	}
+	RunningScript(const RunningScript&) = delete;
+	RunningScript& operator=(const RunningScript&) = delete;
 };
 
 struct JSValue : RefCounted
@@ -163,6 +707,78 @@ struct JSString : JSValue
 	inline v8::Local<v8::String> LocalHandle(JSContext* context) { return Handle.Get(context->Isolate); }
 };
 
+JSContext::JSContext(
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer,
+	JSIsolate* owner,
+	JSIsolatePool* pool)
+	: CallbackFinalizer(callbackFinalizer)
+	, ExternalFinalizer(externalFinalizer)
+	, Owner(owner)
+	, Pool(pool)
+	, Isolate(owner->Isolate)
+	, DebugMessageHandler(nullptr)
+	, DebugMessageHandlerData(nullptr)
+{
+	if (Pool != nullptr)
+		Pool->Retain();
+
+	v8::Locker locker(Isolate);
+	v8::Isolate::Scope isolateScope(Isolate);
+	v8::HandleScope handleScope(Isolate);
+
+	auto localContext = Owner->HasSnapshot()
+		? v8::Context::FromSnapshot(Isolate, 0).FromMaybe(v8::Local<v8::Context>())
+		: v8::Local<v8::Context>();
+	if (localContext.IsEmpty())
+		localContext = v8::Context::New(Isolate);
+	v8::Context::Scope contextScope(localContext);
+	localContext->SetAlignedPointerInEmbedderData(EmbedderDataIndex, this);
+
+	Handle.Reset(Isolate, localContext);
+}
+
+JSContext::~JSContext()
+{
+	auto oldData = DebugMessageHandlerData;
+	DebugMessageHandler = nullptr;
+	DebugMessageHandlerData = nullptr;
+	if (ExternalFinalizer != nullptr && oldData != nullptr)
+		ExternalFinalizer(oldData);
+	ReleaseInternedStrings();
+	{
+		// Functions from this context can outlive it
+		v8::Locker locker(Isolate);
+		v8::Isolate::Scope isolateScope(Isolate);
+		v8::HandleScope handleScope(Isolate);
+		LocalHandle()->SetAlignedPointerInEmbedderData(EmbedderDataIndex, nullptr);
+		if (Owner->DebugContext == this)
+		{
+			v8::Debug::SetMessageHandler(Isolate, nullptr);
+			Owner->DebugContext = nullptr;
+		}
+	}
+	Handle.Reset();
+
+	if (Pool != nullptr)
+	{
+		Pool->Return(Owner);
+		Pool->Release();
+	}
+	else
+	{
+		Owner->Release();
+	}
+	Isolate = nullptr;
+}
+
+void JSContext::ReleaseInternedStrings()
+{
+	for (auto& entry : InternedStrings)
+		entry.second->Release();
+	InternedStrings.clear();
+}
+
 struct JSBool : JSValue
 {
 	virtual JSType Type() const override { return JSType::Bool; }
@@ -218,30 +834,41 @@ struct JSExternal : JSValue
 	inline v8::Local<v8::External> LocalHandle(JSContext* context) { return Handle.Get(context->Isolate); }
 };
 
+// Only keeps the V8 exception and message around; the fields exposed through
+// the getters are computed the first time they are asked for.
+// Retains its context, since the fields are read from it lazily
 struct JSScriptException : RefCounted
 {
+	JSContext* const Context;
+	ResettingPersistent<v8::Value> ExceptionHandle;
+	ResettingPersistent<v8::Message> MessageHandle;
+
+	bool HasException;
 	JSValue* Exception;
 	JSString* ErrorMessage;
 	JSString* FileName;
+	bool HasLineNumber;
 	int LineNumber;
 	JSString* StackTrace;
 	JSString* SourceLine;
 
-	// Note: Assumes that all arguments are retained
 	JSScriptException(
-		JSValue* exception,
-		JSString* errorMessage,
-		JSString* fileName,
-		int lineNumber,
-		JSString* stackTrace,
-		JSString* sourceLine)
-		: Exception(exception)
-		, ErrorMessage(errorMessage)
-		, FileName(fileName)
-		, LineNumber(lineNumber)
-		, StackTrace(stackTrace)
-		, SourceLine(sourceLine)
+		JSContext* context,
+		v8::Local<v8::Value> exception,
+		v8::Local<v8::Message> message)
+		: Context(context)
+		, ExceptionHandle(context->Isolate, exception)
+		, MessageHandle(context->Isolate, message)
+		, HasException(false)
+		, Exception(nullptr)
+		, ErrorMessage(nullptr)
+		, FileName(nullptr)
+		, HasLineNumber(false)
+		, LineNumber(-1)
+		, StackTrace(nullptr)
+		, SourceLine(nullptr)
 	{
+		Context->Retain();
 	}
 
 	~JSScriptException()
@@ -251,131 +878,193 @@ struct JSScriptException : RefCounted
 		if (FileName != nullptr) FileName->Release();
 		if (StackTrace != nullptr) StackTrace->Release();
 		if (SourceLine != nullptr) SourceLine->Release();
+		// Before the context, which may take the isolate with it
+		ExceptionHandle.Reset();
+		MessageHandle.Reset();
+		Context->Release();
 	}
+
+	inline v8::Local<v8::Message> LocalMessage() { return MessageHandle.Get(Context->Isolate); }
+
+	JSValue* LazyException();
+	JSString* LazyMessage();
+	JSString* LazyFileName();
+	int LazyLineNumber();
+	JSString* LazyStackTrace();
+	JSString* LazySourceLine();
 };
 
-template<typename T>
-inline static auto TryCatch(
-	JSScriptException** outError,
-	const V8Scope& scope,
-	T inner) -> decltype(inner((v8::TryCatch&)*(v8::TryCatch*)nullptr))
+// The code cache and snapshot bytes handed out to callers are prefixed with
+// the CachedDataVersionTag of the V8 that produced them, so that stale data
+// can be rejected without handing it to V8.
+struct VersionedBlob : RefCounted
 {
-	*outError = nullptr;
-	try
+	std::vector<uint8_t> Data;
+
+	VersionedBlob(const void* data, int length)
+		: Data(sizeof(uint32_t) + length)
 	{
-		v8::TryCatch tryCatch;
-		return inner(tryCatch);
+		uint32_t versionTag = v8::ScriptCompiler::CachedDataVersionTag();
+		memcpy(&Data[0], &versionTag, sizeof(versionTag));
+		memcpy(&Data[sizeof(versionTag)], data, length);
 	}
-	catch (JSScriptException* exception)
+
+	static bool IsCurrentVersion(const uint8_t* data, int length)
 	{
-		*outError = exception;
-		return decltype(inner((v8::TryCatch&)*(v8::TryCatch*)nullptr))();
+		uint32_t versionTag;
+		if (data == nullptr || length <= (int)sizeof(versionTag))
+			return false;
+		memcpy(&versionTag, data, sizeof(versionTag));
+		return versionTag == v8::ScriptCompiler::CachedDataVersionTag();
 	}
-}
 
-template<typename T>
-inline static auto TryCatch(
-	JSScriptException** outError,
-	JSContext* context,
-	T inner) -> decltype(inner((v8::TryCatch&)*(v8::TryCatch*)nullptr))
-{
-	V8Scope scope(context);
-	return TryCatch(outError, scope, inner);
-}
-
-static JSValue* Wrap(JSContext* context, const v8::TryCatch& tryCatch, v8::Local<v8::Value> value);
+	static const uint8_t* Payload(const uint8_t* data) { return data + sizeof(uint32_t); }
+	static int PayloadLength(int length) { return length - (int)sizeof(uint32_t); }
+};
 
-static void Throw(JSContext* context, const v8::TryCatch& tryCatch)
+struct JSCodeCache : VersionedBlob
 {
-	v8::Local<v8::String> emptyString = v8::String::Empty(context->Isolate);
-
-	v8::Local<v8::Message> message = tryCatch.Message();
-	v8::Local<v8::String> sourceLine(emptyString);
-	v8::Local<v8::String> messageStr(emptyString);
-	v8::Local<v8::String> fileName(emptyString);
-	int lineNumber = -1;
-	auto localContext = context->LocalHandle();
-	if (!message.IsEmpty())
+	JSCodeCache(const v8::ScriptCompiler::CachedData* cachedData)
+		: VersionedBlob(cachedData->data, cachedData->length)
 	{
-		sourceLine = message->GetSourceLine(localContext).FromMaybe(emptyString);
-		auto messageStrLocal = message->Get();
-		if (!messageStrLocal.IsEmpty())
-		{
-			messageStr = messageStrLocal;
-		}
-		fileName = message->GetScriptResourceName()->ToString(localContext).FromMaybe(emptyString);
-		lineNumber = message->GetLineNumber(localContext).FromMaybe(-1);
 	}
+};
 
-	JSValue* exception = nullptr;
-	if (!tryCatch.Exception().IsEmpty())
+struct JSSnapshot : VersionedBlob
+{
+	JSSnapshot(const v8::StartupData& startupData)
+		: VersionedBlob(startupData.data, startupData.raw_size)
 	{
-		v8::TryCatch innerTryCatch;
-		exception = Wrap(context, innerTryCatch, tryCatch.Exception());
 	}
+};
 
-	v8::Local<v8::String> stackTrace(
-		tryCatch
-		.StackTrace(localContext)
-		.FromMaybe(emptyString.As<v8::Value>())
-		->ToString(localContext)
-		.FromMaybe(emptyString));
+struct JSScript : RefCounted
+{
+	v8::Isolate* const Isolate;
+	ResettingPersistent<v8::UnboundScript> Handle;
+	JSScript(v8::Isolate* isolate, const v8::Local<v8::UnboundScript>& handle)
+		: Isolate(isolate)
+		, Handle(isolate, handle)
+	{
+	}
+	inline v8::Local<v8::UnboundScript> LocalHandle() { return Handle.Get(Isolate); }
+};
 
-	throw new JSScriptException(
-		exception,
-		new JSString(context->Isolate, messageStr),
-		new JSString(context->Isolate, fileName),
-		lineNumber,
-		new JSString(context->Isolate, stackTrace),
-		new JSString(context->Isolate, sourceLine));
+static JSScriptException* NewScriptException(JSContext* context, const v8::TryCatch& tryCatch)
+{
+	return new JSScriptException(context, tryCatch.Exception(), tryCatch.Message());
 }
 
-template<class A>
-inline static v8::Local<A> FromJust(
-	JSContext* context,
-	const v8::TryCatch& tryCatch,
-	v8::MaybeLocal<A> a)
+// Hands anything caught by tryCatch to the caller when going out of scope
+struct CatchToOutError
 {
-	if (tryCatch.HasCaught() || a.IsEmpty())
+	JSScriptException** const OutError;
+	JSContext* const Context;
+	const v8::TryCatch& TryCatch;
+
+	~CatchToOutError()
 	{
-		Throw(context, tryCatch);
+		if (TryCatch.HasCaught())
+			*OutError = NewScriptException(Context, TryCatch);
 	}
-	return a.ToLocalChecked();
+};
+
+// Runs inner(tryCatch) under a scope and a v8::TryCatch. inner signals
+// failure by returning early (with nullptr or a default value) once a V8 call
+// comes back empty, which leaves the exception in tryCatch. Nothing here
+// throws C++ exceptions, so the library builds with -fno-exceptions.
+template<typename T>
+inline static auto TryCatch(
+	JSScriptException** outError,
+	JSContext* context,
+	T inner) -> decltype(inner((v8::TryCatch&)*(v8::TryCatch*)nullptr))
+{
+	*outError = nullptr;
+	V8Scope scope(context);
+	RunningScript runningScript(context->Owner);
+	v8::TryCatch tryCatch;
+	CatchToOutError catchToOutError{outError, context, tryCatch};
+	return inner(tryCatch);
 }
 
-template<class A>
-inline static A FromJust(
+// Runs inner(tryCatch, i) for each i in [0, count) under a single scope and
+// TryCatch, storing the error of each failed item in outErrors[i]. Returns the
+// number of failed items.
+template<typename T>
+inline static int TryCatchEach(
+	JSScriptException** outErrors,
 	JSContext* context,
-	const v8::TryCatch& tryCatch,
-	v8::Maybe<A> a)
+	int count,
+	T inner)
 {
-	if (tryCatch.HasCaught() || a.IsNothing())
+	V8Scope scope(context);
+	RunningScript runningScript(context->Owner);
+	v8::TryCatch tryCatch;
+	int numErrors = 0;
+	for (int i = 0; i < count; ++i)
 	{
-		Throw(context, tryCatch);
+		outErrors[i] = nullptr;
+		{
+			v8::HandleScope handleScope(context->Isolate);
+			inner(tryCatch, i);
+		}
+		if (tryCatch.HasCaught())
+		{
+			outErrors[i] = NewScriptException(context, tryCatch);
+			++numErrors;
+			tryCatch.Reset();
+		}
 	}
-	return a.FromJust();
+	return numErrors;
+}
+
+// Booleans and small ints are boxed by shared instances that are never freed,
+// which keeps wrapping them allocation-free
+static const int SharedIntMin = -1;
+static const int SharedIntMax = 255;
+
+static std::vector<JSInt*> NewSharedInts()
+{
+	std::vector<JSInt*> ints;
+	for (int i = SharedIntMin; i <= SharedIntMax; ++i)
+		ints.push_back(new JSInt(i));
+	return ints;
 }
 
-static JSValue* Wrap(JSContext* context, const v8::TryCatch& tryCatch, v8::Local<v8::Value> value)
+static JSBool* const _sharedBools[] = { new JSBool(false), new JSBool(true) };
+static const std::vector<JSInt*> _sharedInts = NewSharedInts();
+
+static JSValue* Wrap(JSContext* context, v8::Local<v8::Value> value)
 {
 	if (value->IsUndefined() || value->IsNull())
 		return nullptr;
 	if (value->IsInt32())
-		return new JSInt(FromJust(context, tryCatch, value->Int32Value(context->LocalHandle())));
+	{
+		auto intValue = value.As<v8::Int32>()->Value();
+		if (intValue < SharedIntMin || intValue > SharedIntMax)
+			return new JSInt(intValue);
+		auto result = _sharedInts[intValue - SharedIntMin];
+		result->Retain();
+		return result;
+	}
 	if (value->IsNumber())
-		return new JSDouble(FromJust(context, tryCatch, value->NumberValue(context->LocalHandle())));
+		return new JSDouble(value.As<v8::Number>()->Value());
 	if (value->IsBoolean())
-		return new JSBool(FromJust(context, tryCatch, value->BooleanValue(context->LocalHandle())));
+	{
+		auto result = _sharedBools[value.As<v8::Boolean>()->Value() ? 1 : 0];
+		result->Retain();
+		return result;
+	}
 	if (value->IsString())
-		return new JSString(context->Isolate, FromJust(context, tryCatch, value->ToString(context->LocalHandle())));
+		return new JSString(context->Isolate, value.As<v8::String>());
 	if (value->IsArray())
-		return new JSArray(context->Isolate, FromJust(context, tryCatch, value->ToObject(context->LocalHandle())).As<v8::Array>());
+		return new JSArray(context->Isolate, value.As<v8::Array>());
 	if (value->IsFunction())
-		return new JSFunction(context->Isolate, FromJust(context, tryCatch, value->ToObject(context->LocalHandle())).As<v8::Function>());
+		return new JSFunction(context->Isolate, value.As<v8::Function>());
 	if (value->IsExternal())
 		return new JSExternal(context->Isolate, value.As<v8::External>());
 	if (value->IsObject())
-		return new JSObject(context->Isolate, FromJust(context, tryCatch, value->ToObject(context->LocalHandle())));
+		return new JSObject(context->Isolate, value.As<v8::Object>());
 	return nullptr; // TODO do something good here
 }
 
@@ -406,236 +1095,770 @@ static v8::Local<v8::Value> Unwrap(v8::Isolate* isolate, JSValue* value)
 	return v8::Null(isolate).As<v8::Value>(); // TODO do something good here
 }
 
-static inline JSValue* WrapMaybe(JSContext* context, const v8::TryCatch& tryCatch, v8::MaybeLocal<v8::Value> value)
+// For V8 calls made only for their side effects. A failure is left in the
+// surrounding v8::TryCatch.
+template<class A>
+inline static void IgnoreResult(v8::Maybe<A>)
 {
-	return Wrap(context, tryCatch, FromJust(context, tryCatch, value));
 }
 
-template<typename T>
-inline static T const* data_ptr(const std::vector<T>& v)
+// Returns nullptr if the V8 call that produced value failed
+static inline JSValue* WrapMaybe(JSContext* context, v8::MaybeLocal<v8::Value> value)
 {
-	return v.size() > 0
-		? &*v.begin()
-		: nullptr;
+	v8::Local<v8::Value> localValue;
+	if (!value.ToLocal(&localValue))
+		return nullptr;
+	return Wrap(context, localValue);
 }
 
-template<typename T>
-inline static T* data_ptr(std::vector<T>& v)
+static_assert(sizeof(JSValueUnboxed) == 16, "JSValueUnboxed must match the managed layout");
+
+static inline bool IsBoxed(JSType type)
 {
-	return v.size() > 0
-		? &*v.begin()
-		: nullptr;
+	switch (type)
+	{
+		case JSType::Null:
+		case JSType::Int:
+		case JSType::Double:
+		case JSType::Bool:
+			return false;
+		default:
+			return true;
+	}
 }
 
-// -------------------------------------------------------------------------
-// Context
-DllPublic void CDecl RetainJSContext(JSContext* context)
+static void WrapUnboxed(JSContext* context, v8::Local<v8::Value> value, JSValueUnboxed* outValue)
 {
-	if (context != nullptr)
+	if (value->IsInt32())
 	{
-		context->Retain();
+		outValue->Type = JSType::Int;
+		outValue->Int = value.As<v8::Int32>()->Value();
+	}
+	else if (value->IsNumber())
+	{
+		outValue->Type = JSType::Double;
+		outValue->Double = value.As<v8::Number>()->Value();
+	}
+	else if (value->IsBoolean())
+	{
+		outValue->Type = JSType::Bool;
+		outValue->Bool = value.As<v8::Boolean>()->Value();
+	}
+	else
+	{
+		outValue->Handle = Wrap(context, value);
+		outValue->Type = GetJSValueType(outValue->Handle);
 	}
 }
 
-DllPublic void CDecl ReleaseJSContext(JSContext* context)
+static v8::Local<v8::Value> UnwrapUnboxed(v8::Isolate* isolate, const JSValueUnboxed& value)
 {
-	if (context != nullptr)
+	switch (value.Type)
 	{
-		v8::Locker(context->Isolate);
-		context->Release();
+		case JSType::Null:
+			return v8::Null(isolate).As<v8::Value>();
+		case JSType::Int:
+			return v8::Int32::New(isolate, value.Int);
+		case JSType::Double:
+			return v8::Number::New(isolate, value.Double);
+		case JSType::Bool:
+			return v8::Boolean::New(isolate, value.Bool);
+		default:
+			return Unwrap(isolate, value.Handle);
 	}
 }
 
-DllPublic JSContext* CDecl CreateJSContext(
-	JSCallbackFinalizer callbackFinalizer,
-	JSExternalFinalizer externalFinalizer)
+static inline void ReleaseUnboxed(const JSValueUnboxed& value)
 {
-	return new JSContext(callbackFinalizer, externalFinalizer);
+	if (IsBoxed(value.Type) && value.Handle != nullptr)
+		value.Handle->Release();
 }
 
-DllPublic JSValue* CDecl JSContextEvaluateCreate(JSContext* context, JSString* fileName, JSString* code, JSScriptException** outError)
+// The data of a native callback function. It's owned by the External
+// returned from New, and the data is finalized when the External is
+// garbage collected. It holds no JSContext, since the function can outlive
+// the one it was created in; callbacks look theirs up when called.
+template<typename TCallback>
+struct Closure
 {
-	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	// Copied, since the isolate can outlive the context
+	JSCallbackFinalizer callbackFinalizer;
+	ResettingPersistent<v8::External> finalizer;
+	void* data;
+	TCallback callback;
+
+	static v8::Local<v8::External> New(JSContext* context, void* data, TCallback callback)
 	{
-		v8::ScriptOrigin origin(fileName->LocalHandle(context));
-		auto script = FromJust(
-			context,
-			tryCatch,
-			v8::Script::Compile(
-				context->LocalHandle(),
-				code->LocalHandle(context),
-				&origin));
+		auto closure = new Closure{context->CallbackFinalizer, {}, data, callback};
 
-		return WrapMaybe(context, tryCatch, script->Run(context->LocalHandle()));
-	});
-}
+		auto localClosure = v8::External::New(context->Isolate, closure);
+		closure->finalizer.Reset(context->Isolate, localClosure);
 
-DllPublic JSObject* CDecl JSContextCopyGlobalObject(JSContext* context)
-{
-	V8Scope scope(context);
-	return new JSObject(context->Isolate, context->LocalHandle()->Global());
-}
+		closure->finalizer.SetWeak(
+			closure,
+			[] (const v8::WeakCallbackInfo<Closure>& data)
+			{
+				auto closure = data.GetParameter();
+				auto f = closure->callbackFinalizer;
+				if (f != nullptr)
+					f(closure->data);
+				closure->finalizer.Reset();
+				delete closure;
+			},
+			v8::WeakCallbackType::kParameter);
 
-DllPublic const char* CDecl GetV8Version() { return v8::V8::GetVersion(); }
+		return localClosure;
+	}
 
-// -------------------------------------------------------------------------
-// Debug
-DllPublic void CDecl SetJSDebugMessageHandler(JSContext* context, void* data, JSDebugMessageHandler messageHandler)
-{
-	static JSContext* debugContext;
-	debugContext = context;
-	if (context->DebugMessageHandlerData != data || context->DebugMessageHandler != messageHandler)
+	static inline Closure* FromData(v8::Local<v8::Value> data)
 	{
-		V8Scope scope(context);
-		auto oldData = context->DebugMessageHandlerData;
-
-		if (messageHandler == nullptr)
-		{
-			context->DebugMessageHandler = nullptr;
-			context->DebugMessageHandlerData = nullptr;
-			v8::Debug::SetMessageHandler(context->Isolate, nullptr);
-		}
-		else
-		{
-			context->DebugMessageHandlerData = data;
-			context->DebugMessageHandler = messageHandler;
-			v8::Debug::SetMessageHandler(context->Isolate, [] (const v8::Debug::Message& message)
-			{
-				auto isolate = message.GetIsolate();
-				v8::HandleScope handleScope(isolate);
-				debugContext->DebugMessageHandler(debugContext->DebugMessageHandlerData, new JSString(isolate, message.GetJSON()));
-			});
-		}
-		if (context->ExternalFinalizer != nullptr && oldData != nullptr)
-			context->ExternalFinalizer(oldData);
+		return static_cast<Closure*>(data.As<v8::External>()->Value());
 	}
-}
+};
 
-DllPublic void CDecl SendJSDebugCommand(JSContext* context, const uint16_t* command, int length)
+// -------------------------------------------------------------------------
+// Platform
+DllPublic void CDecl InitializeV8Simple(const JSPlatformOptions* options, JSRuntimeError* outError)
 {
-	v8::Debug::SendCommand(context->Isolate, command, length);
+	*outError = JSRuntimeError::NoError;
+	std::lock_guard<std::mutex> lock(_platformMutex);
+	if (_platformShutDown)
+		*outError = JSRuntimeError::ShutDown;
+	else if (!InitializeV8Locked(JSPlatformOptions{options->WorkerThreads < 0 ? 0 : options->WorkerThreads}))
+		*outError = JSRuntimeError::AlreadyInitialized;
 }
 
-DllPublic void CDecl ProcessJSDebugMessages(JSContext* context)
+DllPublic bool CDecl GetV8SimplePlatformOptions(JSPlatformOptions* outOptions)
 {
-	V8Scope scope(context);
-	v8::Debug::ProcessDebugMessages(context->Isolate);
+	std::lock_guard<std::mutex> lock(_platformMutex);
+	if (_platform == nullptr)
+		return false;
+	*outOptions = _platformOptions;
+	return true;
 }
 
-// -------------------------------------------------------------------------
-// Value
-DllPublic JSType CDecl GetJSValueType(JSValue* value) { return value == nullptr ? JSType::Null : value->Type(); }
-DllPublic void CDecl RetainJSValue(JSContext* context, JSValue* value)
-{
-	if (value != nullptr)
-		value->Retain();
-}
-DllPublic void CDecl ReleaseJSValue(JSContext* context, JSValue* value)
+DllPublic bool CDecl ShutdownV8Simple()
 {
-	if (value != nullptr && context != nullptr)
-	{
-		v8::Locker(context->Isolate);
-		value->Release();
-	}
-	else
+	std::lock_guard<std::mutex> lock(_platformMutex);
+	if (_liveIsolates > 0)
+		return false;
+	if (_platform != nullptr)
 	{
-		// Leak
+		v8::V8::Dispose();
+		v8::V8::ShutdownPlatform();
+		delete _platform;
+		_platform = nullptr;
 	}
+	// Also without a platform, since V8 cannot be initialized twice
+	_platformShutDown = true;
+	return true;
 }
 
-DllPublic int CDecl JSValueAsInt(JSValue* value, JSRuntimeError* outError)
+// Takes ownership of isolate, which is null once V8 is shut down
+static JSContext* NewContext(
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer,
+	JSIsolate* isolate,
+	JSRuntimeError* outError = nullptr)
 {
-	*outError = JSRuntimeError::NoError;
-	if (GetJSValueType(value) != JSType::Int)
+	if (isolate == nullptr)
 	{
-		*outError = JSRuntimeError::InvalidCast;
-		return 0;
+		if (outError != nullptr)
+			*outError = JSRuntimeError::ShutDown;
+		return nullptr;
 	}
-	return static_cast<JSInt*>(value)->Value;
+	return new JSContext(callbackFinalizer, externalFinalizer, isolate);
 }
 
-DllPublic double CDecl JSValueAsDouble(JSValue* value, JSRuntimeError* outError)
+// -------------------------------------------------------------------------
+// Context
+DllPublic void CDecl RetainJSContext(JSContext* context)
 {
-	*outError = JSRuntimeError::NoError;
-	if (GetJSValueType(value) != JSType::Double)
+	if (context != nullptr)
 	{
-		*outError = JSRuntimeError::InvalidCast;
-		return 0.0;
+		context->Retain();
 	}
-	return static_cast<JSDouble*>(value)->Value;
 }
 
-DllPublic JSString* CDecl JSValueAsString(JSValue* value, JSRuntimeError* outError)
+DllPublic void CDecl ReleaseJSContext(JSContext* context)
 {
-	*outError = JSRuntimeError::NoError;
-	if (GetJSValueType(value) != JSType::String)
+	if (context != nullptr)
 	{
-		*outError = JSRuntimeError::InvalidCast;
-		return nullptr;
+		v8::Locker(context->Isolate);
+		context->Release();
 	}
-	return static_cast<JSString*>(value);
 }
 
-DllPublic bool CDecl JSValueAsBool(JSValue* value, JSRuntimeError* outError)
+DllPublic void CDecl EnterJSContextScope(JSContext* context)
 {
-	*outError = JSRuntimeError::NoError;
-	if (GetJSValueType(value) != JSType::Bool)
-	{
-		*outError = JSRuntimeError::InvalidCast;
-		return false;
-	}
-	return static_cast<JSBool*>(value)->Value;
+	context->Retain();
+	_enteredScopes.push_back(new JSContextScope(context));
 }
 
-DllPublic JSObject* CDecl JSValueAsObject(JSValue* value, JSRuntimeError* outError)
+DllPublic void CDecl ExitJSContextScope(JSContext* context, JSRuntimeError* outError)
 {
 	*outError = JSRuntimeError::NoError;
-	auto type = GetJSValueType(value);
-	if (type != JSType::Object && type != JSType::Null)
+	if (!IsEntered(context))
 	{
-		*outError = JSRuntimeError::InvalidCast;
-		return nullptr;
+		*outError = JSRuntimeError::WrongContext;
+		return;
 	}
-	return static_cast<JSObject*>(value);
+	delete _enteredScopes.back();
+	_enteredScopes.pop_back();
+	context->Release();
 }
 
-DllPublic JSArray* CDecl JSValueAsArray(JSValue* value, JSRuntimeError* outError)
+DllPublic JSContext* CDecl CreateJSContext(
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer)
 {
-	*outError = JSRuntimeError::NoError;
-	if (GetJSValueType(value) != JSType::Array)
-	{
-		*outError = JSRuntimeError::InvalidCast;
-		return nullptr;
-	}
-	return static_cast<JSArray*>(value);
+	return NewContext(callbackFinalizer, externalFinalizer, JSIsolate::New());
 }
 
-DllPublic JSFunction* CDecl JSValueAsFunction(JSValue* value, JSRuntimeError* outError)
+DllPublic JSContext* CDecl CreateJSContextWithArrayBufferAllocator(
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer,
+	JSArrayBufferAllocatorType allocatorType)
+{
+	return NewContext(
+		callbackFinalizer,
+		externalFinalizer,
+		JSIsolate::New(nullptr, 0, DefaultIsolateOptions(allocatorType)));
+}
+
+DllPublic void CDecl GetJSContextArrayBufferAllocatorStatistics(JSContext* context, JSArrayBufferAllocatorStatistics* outStatistics)
+{
+	context->Owner->Allocator->GetStatistics(outStatistics);
+}
+
+DllPublic JSContext* CDecl CreateJSContextWithOptions(
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer,
+	const JSIsolateOptions* options,
+	JSRuntimeError* outError)
 {
 	*outError = JSRuntimeError::NoError;
-	if (GetJSValueType(value) != JSType::Function)
+	if (!IsValid(*options))
 	{
-		*outError = JSRuntimeError::InvalidCast;
+		*outError = JSRuntimeError::RangeError;
 		return nullptr;
 	}
-	return static_cast<JSFunction*>(value);
+	return NewContext(callbackFinalizer, externalFinalizer, JSIsolate::New(nullptr, 0, *options), outError);
 }
 
-DllPublic JSExternal* CDecl JSValueAsExternal(JSValue* value, JSRuntimeError* outError)
+DllPublic JSIsolate* CDecl GetJSContextIsolate(JSContext* context) { return context->Owner; }
+
+DllPublic JSContext* CDecl CreateJSContextFromSnapshot(
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer,
+	const uint8_t* snapshot,
+	int snapshotLength,
+	JSRuntimeError* outError)
 {
 	*outError = JSRuntimeError::NoError;
-	if (GetJSValueType(value) != JSType::External)
+	if (!JSSnapshot::IsCurrentVersion(snapshot, snapshotLength))
 	{
-		*outError = JSRuntimeError::InvalidCast;
+		*outError = JSRuntimeError::SnapshotError;
 		return nullptr;
 	}
-	return static_cast<JSExternal*>(value);
+	return NewContext(
+		callbackFinalizer,
+		externalFinalizer,
+		JSIsolate::New(JSSnapshot::Payload(snapshot), JSSnapshot::PayloadLength(snapshotLength)),
+		outError);
 }
 
-DllPublic bool CDecl JSValueStrictEquals(JSContext* context, JSValue* obj1, JSValue* obj2)
+DllPublic JSValue* CDecl JSContextEvaluateCreate(JSContext* context, JSString* fileName, JSString* code, JSScriptException** outError)
 {
-	V8Scope scope(context);
-	return Unwrap(context->Isolate, obj1)->StrictEquals(Unwrap(context->Isolate, obj2));
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSValue*
+	{
+		v8::ScriptOrigin origin(fileName->LocalHandle(context));
+		v8::Local<v8::Script> script;
+		if (!v8::Script::Compile(
+				context->LocalHandle(),
+				code->LocalHandle(context),
+				&origin).ToLocal(&script))
+			return nullptr;
+
+		return WrapMaybe(context, script->Run(context->LocalHandle()));
+	});
+}
+
+// Compiles code only for its code cache. Without an origin the compile
+// misses the compilation cache entry of the script being evaluated.
+static JSCodeCache* ProduceCodeCache(JSContext* context, JSString* code)
+{
+	v8::TryCatch tryCatch;
+	v8::ScriptCompiler::Source source(code->LocalHandle(context));
+	v8::Local<v8::Script> script;
+	if (!v8::ScriptCompiler::Compile(
+			context->LocalHandle(),
+			&source,
+			v8::ScriptCompiler::kProduceCodeCache).ToLocal(&script))
+		return nullptr;
+	auto cachedData = source.GetCachedData();
+	return cachedData != nullptr && cachedData->length > 0
+		? new JSCodeCache(cachedData)
+		: nullptr;
+}
+
+DllPublic JSValue* CDecl JSContextEvaluateCachedCreate(JSContext* context, JSString* fileName, JSString* code, const uint8_t* cache, int cacheLength, JSCodeCache** outCache, bool* outCacheRejected, JSScriptException** outError)
+{
+	*outCache = nullptr;
+	*outCacheRejected = false;
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSValue*
+	{
+		v8::ScriptOrigin origin(fileName->LocalHandle(context));
+
+		auto consume = JSCodeCache::IsCurrentVersion(cache, cacheLength);
+		*outCacheRejected = cache != nullptr && !consume;
+		v8::ScriptCompiler::Source source(
+			code->LocalHandle(context),
+			origin,
+			consume
+				? new v8::ScriptCompiler::CachedData(
+					JSCodeCache::Payload(cache),
+					JSCodeCache::PayloadLength(cacheLength))
+				: nullptr);
+
+		v8::Local<v8::Script> script;
+		if (!v8::ScriptCompiler::Compile(
+				context->LocalHandle(),
+				&source,
+				consume
+					? v8::ScriptCompiler::kConsumeCodeCache
+					: v8::ScriptCompiler::kProduceCodeCache).ToLocal(&script))
+			return nullptr;
+
+		auto cachedData = source.GetCachedData();
+		if (consume)
+			*outCacheRejected = cachedData->rejected;
+		if (!consume && cachedData != nullptr && cachedData->length > 0)
+			*outCache = new JSCodeCache(cachedData);
+		else if (!consume || *outCacheRejected)
+			// Replace a rejected cache, so that it is only rejected once,
+			// and fill in when the compile above came from the isolate's
+			// compilation cache, which skips producing
+			*outCache = ProduceCodeCache(context, code);
+
+		return WrapMaybe(context, script->Run(context->LocalHandle()));
+	});
+}
+
+DllPublic JSObject* CDecl JSContextCopyGlobalObject(JSContext* context)
+{
+	V8Scope scope(context);
+	return new JSObject(context->Isolate, context->LocalHandle()->Global());
+}
+
+DllPublic const char* CDecl GetV8Version() { return v8::V8::GetVersion(); }
+
+// -------------------------------------------------------------------------
+// Code cache
+DllPublic void CDecl ReleaseJSCodeCache(JSCodeCache* cache)
+{
+	if (cache != nullptr)
+		cache->Release();
+}
+DllPublic const uint8_t* CDecl GetJSCodeCacheData(JSCodeCache* cache) { return data_ptr(cache->Data); }
+DllPublic int CDecl GetJSCodeCacheLength(JSCodeCache* cache) { return static_cast<int>(cache->Data.size()); }
+DllPublic uint32_t CDecl GetJSCodeCacheVersionTag() { return v8::ScriptCompiler::CachedDataVersionTag(); }
+
+// -------------------------------------------------------------------------
+// Snapshot
+DllPublic JSSnapshot* CDecl CreateJSSnapshot(const uint16_t* code, int codeLength, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (!AcquireV8())
+	{
+		*outError = JSRuntimeError::ShutDown;
+		return nullptr;
+	}
+
+	v8::StartupData startupData{nullptr, 0};
+	{
+		v8::SnapshotCreator snapshotCreator;
+		auto isolate = snapshotCreator.GetIsolate();
+		{
+			v8::HandleScope handleScope(isolate);
+			auto localContext = v8::Context::New(isolate);
+			v8::Context::Scope contextScope(localContext);
+			v8::TryCatch tryCatch(isolate);
+
+			v8::Local<v8::String> source;
+			v8::Local<v8::Script> script;
+			if (!v8::String::NewFromTwoByte(isolate, code, v8::NewStringType::kNormal, codeLength).ToLocal(&source))
+				*outError = JSRuntimeError::StringTooLong;
+			else if (!v8::Script::Compile(localContext, source).ToLocal(&script)
+				|| script->Run(localContext).IsEmpty())
+				*outError = JSRuntimeError::ScriptError;
+			else
+				snapshotCreator.AddContext(localContext);
+		}
+		startupData = snapshotCreator.CreateBlob(v8::SnapshotCreator::FunctionCodeHandling::kClear);
+	}
+	ReleaseV8();
+
+	JSSnapshot* result = nullptr;
+	if (*outError == JSRuntimeError::NoError)
+	{
+		if (startupData.data == nullptr)
+			*outError = JSRuntimeError::SnapshotError;
+		else
+			result = new JSSnapshot(startupData);
+	}
+	delete[] startupData.data;
+	return result;
+}
+
+DllPublic void CDecl ReleaseJSSnapshot(JSSnapshot* snapshot)
+{
+	if (snapshot != nullptr)
+		snapshot->Release();
+}
+DllPublic const uint8_t* CDecl GetJSSnapshotData(JSSnapshot* snapshot) { return data_ptr(snapshot->Data); }
+DllPublic int CDecl GetJSSnapshotLength(JSSnapshot* snapshot) { return static_cast<int>(snapshot->Data.size()); }
+
+// -------------------------------------------------------------------------
+// Isolate
+DllPublic JSIsolate* CDecl CreateJSIsolateWithOptions(const JSIsolateOptions* options, const uint8_t* snapshot, int snapshotLength, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (!IsValid(*options))
+	{
+		*outError = JSRuntimeError::RangeError;
+		return nullptr;
+	}
+	JSIsolate* result;
+	if (snapshot == nullptr)
+		result = JSIsolate::New(nullptr, 0, *options);
+	else if (!JSSnapshot::IsCurrentVersion(snapshot, snapshotLength))
+	{
+		*outError = JSRuntimeError::SnapshotError;
+		return nullptr;
+	}
+	else
+		result = JSIsolate::New(
+			JSSnapshot::Payload(snapshot),
+			JSSnapshot::PayloadLength(snapshotLength),
+			*options);
+	if (result == nullptr)
+		*outError = JSRuntimeError::ShutDown;
+	return result;
+}
+
+DllPublic JSIsolate* CDecl CreateJSIsolate(const uint8_t* snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, JSRuntimeError* outError)
+{
+	auto options = DefaultIsolateOptions(allocatorType);
+	return CreateJSIsolateWithOptions(&options, snapshot, snapshotLength, outError);
+}
+
+DllPublic void CDecl GetJSIsolateHeapStatistics(JSIsolate* isolate, JSHeapStatistics* outStatistics)
+{
+	v8::Locker locker(isolate->Isolate);
+	v8::HeapStatistics statistics;
+	isolate->Isolate->GetHeapStatistics(&statistics);
+	outStatistics->TotalHeapSize = static_cast<int64_t>(statistics.total_heap_size());
+	outStatistics->UsedHeapSize = static_cast<int64_t>(statistics.used_heap_size());
+	outStatistics->HeapSizeLimit = static_cast<int64_t>(statistics.heap_size_limit());
+	outStatistics->HeapLimitTerminations = isolate->HeapLimitTerminations;
+	// Adjusting by zero reads the current amount
+	outStatistics->ExternalMemory = isolate->Isolate->AdjustAmountOfExternalAllocatedMemory(0);
+}
+
+DllPublic void CDecl RetainJSIsolate(JSIsolate* isolate)
+{
+	if (isolate != nullptr)
+		isolate->Retain();
+}
+
+DllPublic void CDecl ReleaseJSIsolate(JSIsolate* isolate)
+{
+	if (isolate != nullptr)
+		isolate->Release();
+}
+
+DllPublic JSContext* CDecl CreateJSContextInIsolate(
+	JSIsolate* isolate,
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer)
+{
+	isolate->Retain();
+	return new JSContext(callbackFinalizer, externalFinalizer, isolate);
+}
+
+// -------------------------------------------------------------------------
+// IsolatePool
+DllPublic JSIsolatePool* CDecl CreateJSIsolatePool(int size, const uint8_t* snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (size < 0)
+	{
+		*outError = JSRuntimeError::RangeError;
+		return nullptr;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_platformMutex);
+		if (_platformShutDown)
+		{
+			*outError = JSRuntimeError::ShutDown;
+			return nullptr;
+		}
+	}
+	if (snapshot == nullptr)
+		return new JSIsolatePool(size, nullptr, 0, allocatorType);
+	if (!JSSnapshot::IsCurrentVersion(snapshot, snapshotLength))
+	{
+		*outError = JSRuntimeError::SnapshotError;
+		return nullptr;
+	}
+	return new JSIsolatePool(
+		size,
+		JSSnapshot::Payload(snapshot),
+		JSSnapshot::PayloadLength(snapshotLength),
+		allocatorType);
+}
+
+DllPublic void CDecl RetainJSIsolatePool(JSIsolatePool* pool)
+{
+	if (pool != nullptr)
+		pool->Retain();
+}
+
+DllPublic void CDecl ReleaseJSIsolatePool(JSIsolatePool* pool)
+{
+	if (pool != nullptr)
+		pool->Release();
+}
+
+DllPublic JSContext* CDecl CreateJSContextFromIsolatePool(
+	JSIsolatePool* pool,
+	JSCallbackFinalizer callbackFinalizer,
+	JSExternalFinalizer externalFinalizer)
+{
+	auto isolate = pool->Checkout();
+	if (isolate == nullptr)
+		return nullptr;
+	return new JSContext(callbackFinalizer, externalFinalizer, isolate, pool);
+}
+
+DllPublic void CDecl GetJSIsolatePoolStatistics(JSIsolatePool* pool, JSIsolatePoolStatistics* outStatistics)
+{
+	std::lock_guard<std::mutex> lock(pool->Mutex);
+	outStatistics->Hits = pool->Hits;
+	outStatistics->Misses = pool->Misses;
+	outStatistics->Idle = static_cast<int64_t>(pool->Idle.size());
+}
+
+// -------------------------------------------------------------------------
+// Script
+DllPublic void CDecl RetainJSScript(JSContext* context, JSScript* script)
+{
+	if (script != nullptr)
+		script->Retain();
+}
+
+DllPublic void CDecl ReleaseJSScript(JSContext* context, JSScript* script)
+{
+	if (script != nullptr)
+	{
+		v8::Locker locker(script->Isolate);
+		script->Release();
+	}
+}
+
+DllPublic JSScript* CDecl CompileJSScript(JSContext* context, JSString* fileName, JSString* code, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSScript*
+	{
+		v8::ScriptOrigin origin(fileName->LocalHandle(context));
+		v8::ScriptCompiler::Source source(code->LocalHandle(context), origin);
+		v8::Local<v8::UnboundScript> script;
+		if (!v8::ScriptCompiler::CompileUnboundScript(context->Isolate, &source).ToLocal(&script))
+			return nullptr;
+		return new JSScript(context->Isolate, script);
+	});
+}
+
+DllPublic JSValue* CDecl RunJSScript(JSContext* context, JSScript* script, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSValue*
+	{
+		if (script->Isolate != context->Isolate)
+		{
+			context->Isolate->ThrowException(v8::Exception::Error(
+				v8::String::NewFromUtf8(
+					context->Isolate,
+					"Script was compiled in a different isolate",
+					v8::NewStringType::kNormal).ToLocalChecked()));
+			return nullptr;
+		}
+		return WrapMaybe(
+			context,
+			script->LocalHandle()->BindToCurrentContext()->Run(context->LocalHandle()));
+	});
+}
+
+// -------------------------------------------------------------------------
+// Debug
+DllPublic void CDecl SetJSDebugMessageHandler(JSContext* context, void* data, JSDebugMessageHandler messageHandler)
+{
+	context->Owner->DebugContext = context;
+	if (context->DebugMessageHandlerData != data || context->DebugMessageHandler != messageHandler)
+	{
+		V8Scope scope(context);
+		auto oldData = context->DebugMessageHandlerData;
+
+		if (messageHandler == nullptr)
+		{
+			context->DebugMessageHandler = nullptr;
+			context->DebugMessageHandlerData = nullptr;
+			v8::Debug::SetMessageHandler(context->Isolate, nullptr);
+		}
+		else
+		{
+			context->DebugMessageHandlerData = data;
+			context->DebugMessageHandler = messageHandler;
+			v8::Debug::SetMessageHandler(context->Isolate, [] (const v8::Debug::Message& message)
+			{
+				auto isolate = message.GetIsolate();
+				auto debugContext = JSIsolate::From(isolate)->DebugContext;
+				if (debugContext == nullptr || debugContext->DebugMessageHandler == nullptr)
+					return;
+				v8::HandleScope handleScope(isolate);
+				debugContext->DebugMessageHandler(debugContext->DebugMessageHandlerData, new JSString(isolate, message.GetJSON()));
+			});
+		}
+		if (context->ExternalFinalizer != nullptr && oldData != nullptr)
+			context->ExternalFinalizer(oldData);
+	}
+}
+
+DllPublic void CDecl SendJSDebugCommand(JSContext* context, const uint16_t* command, int length)
+{
+	v8::Debug::SendCommand(context->Isolate, command, length);
+}
+
+DllPublic void CDecl ProcessJSDebugMessages(JSContext* context)
+{
+	V8Scope scope(context);
+	v8::Debug::ProcessDebugMessages(context->Isolate);
+}
+
+// -------------------------------------------------------------------------
+// Value
+DllPublic JSType CDecl GetJSValueType(JSValue* value) { return value == nullptr ? JSType::Null : value->Type(); }
+DllPublic void CDecl RetainJSValue(JSContext* context, JSValue* value)
+{
+	if (value != nullptr)
+		value->Retain();
+}
+DllPublic void CDecl ReleaseJSValue(JSContext* context, JSValue* value)
+{
+	if (value != nullptr && context != nullptr)
+	{
+		v8::Locker(context->Isolate);
+		value->Release();
+	}
+	else
+	{
+		// Leak
+	}
+}
+
+DllPublic int CDecl JSValueAsInt(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (GetJSValueType(value) != JSType::Int)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return 0;
+	}
+	return static_cast<JSInt*>(value)->Value;
+}
+
+DllPublic double CDecl JSValueAsDouble(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (GetJSValueType(value) != JSType::Double)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return 0.0;
+	}
+	return static_cast<JSDouble*>(value)->Value;
+}
+
+DllPublic JSString* CDecl JSValueAsString(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (GetJSValueType(value) != JSType::String)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return nullptr;
+	}
+	return static_cast<JSString*>(value);
+}
+
+DllPublic bool CDecl JSValueAsBool(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (GetJSValueType(value) != JSType::Bool)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return false;
+	}
+	return static_cast<JSBool*>(value)->Value;
+}
+
+DllPublic JSObject* CDecl JSValueAsObject(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	auto type = GetJSValueType(value);
+	if (type != JSType::Object && type != JSType::Null)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return nullptr;
+	}
+	return static_cast<JSObject*>(value);
+}
+
+DllPublic JSArray* CDecl JSValueAsArray(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (GetJSValueType(value) != JSType::Array)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return nullptr;
+	}
+	return static_cast<JSArray*>(value);
+}
+
+DllPublic JSFunction* CDecl JSValueAsFunction(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (GetJSValueType(value) != JSType::Function)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return nullptr;
+	}
+	return static_cast<JSFunction*>(value);
+}
+
+DllPublic JSExternal* CDecl JSValueAsExternal(JSValue* value, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	if (GetJSValueType(value) != JSType::External)
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return nullptr;
+	}
+	return static_cast<JSExternal*>(value);
+}
+
+DllPublic bool CDecl JSValueStrictEquals(JSContext* context, JSValue* obj1, JSValue* obj2)
+{
+	V8Scope scope(context);
+	return Unwrap(context->Isolate, obj1)->StrictEquals(Unwrap(context->Isolate, obj2));
 }
 
 // --------------------------------------------------------------------------
@@ -648,117 +1871,380 @@ DllPublic JSValue* CDecl CreateJSBool(bool value) { return new JSBool(value); }
 DllPublic JSObject* CDecl CreateExternalJSArrayBuffer(JSContext* context, void* data, int byteLength)
 {
 	V8Scope scope(context);
-	return new JSObject(context->Isolate, v8::ArrayBuffer::New(context->Isolate, data, (size_t)byteLength));
+	return new JSObject(context->Isolate, v8::ArrayBuffer::New(context->Isolate, data, (size_t)byteLength));
+}
+
+DllPublic JSObject* CDecl CreateOwnedJSArrayBuffer(JSContext* context, void* data, int byteLength, void* owner)
+{
+	V8Scope scope(context);
+
+	auto localArrayBuffer = v8::ArrayBuffer::New(context->Isolate, data, (size_t)byteLength);
+
+	struct Closure
+	{
+		ResettingPersistent<v8::ArrayBuffer> finalizer;
+		JSExternalFinalizer externalFinalizer;
+		void* owner;
+		int byteLength;
+	};
+
+	auto closure = new Closure{{}, context->ExternalFinalizer, owner, byteLength};
+	closure->finalizer.Reset(context->Isolate, localArrayBuffer);
+	context->Isolate->AdjustAmountOfExternalAllocatedMemory(byteLength);
+
+	closure->finalizer.SetWeak(
+		closure,
+		[] (const v8::WeakCallbackInfo<Closure>& data)
+		{
+			auto closure = data.GetParameter();
+			data.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(-static_cast<int64_t>(closure->byteLength));
+			if (closure->externalFinalizer != nullptr)
+				closure->externalFinalizer(closure->owner);
+			closure->finalizer.Reset();
+			delete closure;
+		},
+		v8::WeakCallbackType::kParameter);
+
+	return new JSObject(context->Isolate, localArrayBuffer);
+}
+
+DllPublic JSFunction* CDecl CreateJSCallback(JSContext* context, void* data, JSCallback callback, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSFunction*
+	{
+		auto localClosure = Closure<JSCallback>::New(context, data, callback);
+
+		struct AutoReleaser
+		{
+			const SmallArray<JSValue*>& _values;
+
+			~AutoReleaser()
+			{
+				for (auto v : _values)
+				{
+					if (v != nullptr)
+						v->Release();
+				}
+			}
+		};
+
+		v8::Local<v8::Function> function;
+		if (!v8::Function::New(
+				context->LocalHandle(),
+				[] (const v8::FunctionCallbackInfo<v8::Value>& info)
+				{
+					auto isolate = info.GetIsolate();
+					v8::HandleScope handleScope(isolate);
+					auto closure = Closure<JSCallback>::FromData(info.Data());
+					auto context = JSContext::FromCurrentOrThrow(isolate);
+					if (context == nullptr)
+						return;
+
+					auto numArgs = info.Length();
+					SmallArray<JSValue*> args(numArgs);
+					AutoReleaser autoRelease{args};
+
+					for (int i = 0; i < numArgs; ++i)
+						args[i] = Wrap(context, info[i]);
+
+					JSValue* error = nullptr;
+					JSValue* result = closure->callback(context, closure->data, data_ptr(args), numArgs, &error);
+
+					info.GetReturnValue().Set(Unwrap(isolate, result));
+
+					if (result != nullptr)
+						result->Release();
+
+					if (error != nullptr)
+					{
+						auto unwrappedError = Unwrap(isolate, error);
+						error->Release();
+						isolate->ThrowException(unwrappedError);
+					}
+				},
+				localClosure.As<v8::Value>()).ToLocal(&function))
+			return nullptr;
+		return new JSFunction(context->Isolate, function);
+	});
+}
+
+template<int...> struct Indices { };
+template<int N, int... Is> struct MakeIndices : MakeIndices<N - 1, N - 1, Is...> { };
+template<int... Is> struct MakeIndices<0, Is...> { typedef Indices<Is...> Type; };
+
+static inline bool FromJS(v8::Local<v8::Context> context, v8::Local<v8::Value> value, int* out)
+{
+	return value->Int32Value(context).To(out);
+}
+
+static inline bool FromJS(v8::Local<v8::Context> context, v8::Local<v8::Value> value, double* out)
+{
+	return value->NumberValue(context).To(out);
+}
+
+template<typename R>
+struct TypedResult
+{
+	template<typename F, typename... Args>
+	static inline void Call(const v8::FunctionCallbackInfo<v8::Value>& info, F function, void* data, Args... args)
+	{
+		info.GetReturnValue().Set(function(data, args...));
+	}
+};
+
+template<>
+struct TypedResult<void>
+{
+	template<typename F, typename... Args>
+	static inline void Call(const v8::FunctionCallbackInfo<v8::Value>&, F function, void* data, Args... args)
+	{
+		function(data, args...);
+	}
+};
+
+// Calls a R(StdCall*)(void*, Args...) with the converted JS arguments. A
+// conversion that throws (in valueOf, say) leaves its exception to the caller.
+template<typename R, typename... Args>
+struct TypedTrampoline
+{
+	typedef R (StdCall *Function)(void*, Args...);
+
+	static void Call(const v8::FunctionCallbackInfo<v8::Value>& info)
+	{
+		Call(info, typename MakeIndices<sizeof...(Args)>::Type());
+	}
+
+	template<int... Is>
+	static void Call(const v8::FunctionCallbackInfo<v8::Value>& info, Indices<Is...>)
+	{
+		auto localContext = info.GetIsolate()->GetCurrentContext();
+		auto closure = Closure<JSTypedFunction>::FromData(info.Data());
+		std::tuple<Args...> args;
+		bool converted = true;
+		// Braced initializers are evaluated left to right
+		int inOrder[] = { 0, (converted = converted && FromJS(localContext, info[Is], &std::get<Is>(args)), 0)... };
+		(void)inOrder;
+		(void)localContext;
+		if (!converted)
+			return;
+		TypedResult<R>::Call(
+			info,
+			reinterpret_cast<Function>(closure->callback),
+			closure->data,
+			std::get<Is>(args)...);
+	}
+};
+
+template<typename R, typename... Args>
+static v8::FunctionCallback SelectTypedTrampoline(const JSTypedSignature& signature);
+
+template<typename R, typename... Args>
+static v8::FunctionCallback AppendTypedArg(const JSTypedSignature&, std::true_type /* full */)
+{
+	return nullptr;
+}
+
+template<typename R, typename... Args>
+static v8::FunctionCallback AppendTypedArg(const JSTypedSignature& signature, std::false_type /* full */)
+{
+	switch (signature.ArgTypes[sizeof...(Args)])
+	{
+		case JSNativeType::Int: return SelectTypedTrampoline<R, Args..., int>(signature);
+		case JSNativeType::Double: return SelectTypedTrampoline<R, Args..., double>(signature);
+		default: return nullptr;
+	}
+}
+
+// Picks the trampoline matching signature, one argument type at a time
+template<typename R, typename... Args>
+static v8::FunctionCallback SelectTypedTrampoline(const JSTypedSignature& signature)
+{
+	if (signature.NumArgs == static_cast<int>(sizeof...(Args)))
+		return &TypedTrampoline<R, Args...>::Call;
+	return AppendTypedArg<R, Args...>(
+		signature,
+		std::integral_constant<bool, sizeof...(Args) == JSTypedSignature::MaxArgs>());
+}
+
+static v8::FunctionCallback SelectTypedTrampoline(const JSTypedSignature& signature)
+{
+	if (signature.NumArgs < 0 || signature.NumArgs > JSTypedSignature::MaxArgs)
+		return nullptr;
+	switch (signature.ReturnType)
+	{
+		case JSNativeType::Void: return SelectTypedTrampoline<void>(signature);
+		case JSNativeType::Int: return SelectTypedTrampoline<int>(signature);
+		case JSNativeType::Double: return SelectTypedTrampoline<double>(signature);
+		case JSNativeType::Bool: return SelectTypedTrampoline<bool>(signature);
+		default: return nullptr;
+	}
+}
+
+DllPublic JSFunction* CDecl CreateJSTypedCallback(JSContext* context, void* data, JSTypedFunction function, const JSTypedSignature* signature, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSFunction*
+	{
+		auto trampoline = SelectTypedTrampoline(*signature);
+		if (trampoline == nullptr)
+		{
+			context->Isolate->ThrowException(v8::Exception::TypeError(
+				v8::String::NewFromUtf8(
+					context->Isolate,
+					"Unsupported typed callback signature",
+					v8::NewStringType::kNormal).ToLocalChecked()));
+			return nullptr;
+		}
+
+		auto localClosure = Closure<JSTypedFunction>::New(context, data, function);
+		v8::Local<v8::Function> localFunction;
+		if (!v8::Function::New(
+				context->LocalHandle(),
+				trampoline,
+				localClosure.As<v8::Value>(),
+				signature->NumArgs).ToLocal(&localFunction))
+			return nullptr;
+		return new JSFunction(context->Isolate, localFunction);
+	});
+}
+
+// --------------------------------------------------------------------------
+// String
+DllPublic JSString* CDecl CreateJSString(JSContext* context, const uint16_t* buffer, int length, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	auto mstr = v8::String::NewFromTwoByte(context->Isolate, buffer, v8::NewStringType::kNormal, length);
+	if (mstr.IsEmpty())
+	{
+		*outError = JSRuntimeError::StringTooLong;
+		return nullptr;
+	}
+	return new JSString(context->Isolate, mstr.ToLocalChecked());
 }
 
-DllPublic JSFunction* CDecl CreateJSCallback(JSContext* context, void* data, JSCallback callback, JSScriptException** outError)
+DllPublic JSString* CDecl GetInternedJSString(JSContext* context, const uint16_t* buffer, int length, JSRuntimeError* outError)
 {
-	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	*outError = JSRuntimeError::NoError;
+	// -1 means null-terminated, as for v8::String::NewFromTwoByte
+	if (length == -1)
 	{
-		struct Closure
-		{
-			JSContext* context;
-			ResettingPersistent<v8::External> finalizer;
-			void* data;
-			JSCallback callback;
-		};
-		auto closure = new Closure{context, {}, data, callback};
+		length = 0;
+		while (buffer[length] != 0)
+			++length;
+	}
+	else if (length < 0)
+	{
+		*outError = JSRuntimeError::RangeError;
+		return nullptr;
+	}
+	V8Scope scope(context);
+	// Reusing the key's storage keeps hits allocation-free
+	context->InternKey.assign(reinterpret_cast<const char16_t*>(buffer), static_cast<size_t>(length));
+	auto it = context->InternedStrings.find(context->InternKey);
+	if (it != context->InternedStrings.end())
+		return it->second;
 
-		auto localClosure = v8::External::New(context->Isolate, closure);
-		closure->finalizer.Reset(context->Isolate, localClosure);
+	auto mstr = v8::String::NewFromTwoByte(context->Isolate, buffer, v8::NewStringType::kInternalized, length);
+	if (mstr.IsEmpty())
+	{
+		*outError = JSRuntimeError::StringTooLong;
+		return nullptr;
+	}
+	auto result = new JSString(context->Isolate, mstr.ToLocalChecked());
+	context->InternedStrings.emplace(context->InternKey, result);
+	return result;
+}
 
-		closure->finalizer.SetWeak(
-			closure,
-			[] (const v8::WeakCallbackInfo<Closure>& data)
-			{
-				auto closure = data.GetParameter();
-				auto f = closure->context->CallbackFinalizer;
-				if (f != nullptr)
-					f(closure->data);
-				closure->finalizer.Reset();
-				delete closure;
-			},
-			v8::WeakCallbackType::kParameter);
+DllPublic JSString* CDecl CreateJSStringFromUtf8(JSContext* context, const char* buffer, int byteLength, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	auto mstr = v8::String::NewFromUtf8(context->Isolate, buffer, v8::NewStringType::kNormal, byteLength);
+	if (mstr.IsEmpty())
+	{
+		*outError = JSRuntimeError::StringTooLong;
+		return nullptr;
+	}
+	return new JSString(context->Isolate, mstr.ToLocalChecked());
+}
 
-		struct AutoReleaser
-		{
-			const std::vector<JSValue*>& _values;
+DllPublic JSString* CDecl CreateJSStringFromOneByte(JSContext* context, const uint8_t* buffer, int length, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	auto mstr = v8::String::NewFromOneByte(context->Isolate, buffer, v8::NewStringType::kNormal, length);
+	if (mstr.IsEmpty())
+	{
+		*outError = JSRuntimeError::StringTooLong;
+		return nullptr;
+	}
+	return new JSString(context->Isolate, mstr.ToLocalChecked());
+}
 
-			~AutoReleaser()
-			{
-				for (auto v : _values)
-				{
-					if (v != nullptr)
-						v->Release();
-				}
-			}
-		};
+// Calls the external finalizer with owner when V8 disposes the string
+template<typename TResource, typename TChar>
+struct ExternalStringResource : TResource
+{
+	const TChar* const Buffer;
+	const size_t Length;
+	const JSExternalFinalizer ExternalFinalizer;
+	void* const Owner;
 
-		return new JSFunction(context->Isolate,
-			FromJust(context, tryCatch, v8::Function::New(
-				context->LocalHandle(),
-				[] (const v8::FunctionCallbackInfo<v8::Value>& info)
-				{
-					auto isolate = info.GetIsolate();
-					v8::HandleScope handleScope(isolate);
-					Closure* closure =
-						static_cast<Closure*>(info.Data().
-							As<v8::External>()
-							->Value());
+	ExternalStringResource(const TChar* buffer, size_t length, JSExternalFinalizer externalFinalizer, void* owner)
+		: Buffer(buffer)
+		, Length(length)
+		, ExternalFinalizer(externalFinalizer)
+		, Owner(owner)
+	{
+	}
 
-					auto numArgs = info.Length();
-					std::vector<JSValue*> args(numArgs);
-					AutoReleaser autoRelease{args};
+	virtual const TChar* data() const override { return Buffer; }
+	virtual size_t length() const override { return Length; }
 
-					try
-					{
-						{
-							v8::TryCatch tryCatch;
-							for (int i = 0; i < numArgs; ++i)
-								args[i] = Wrap(closure->context, tryCatch, info[i]);
-						}
-
-						JSValue* error = nullptr;
-						JSValue* result = closure->callback(closure->context, closure->data, data_ptr(args), numArgs, &error);
-
-						info.GetReturnValue().Set(Unwrap(isolate, result));
-
-						if (result != nullptr)
-							result->Release();
-
-						if (error != nullptr)
-						{
-							auto unwrappedError = Unwrap(isolate, error);
-							error->Release();
-							isolate->ThrowException(unwrappedError);
-						}
-					}
-					catch (JSScriptException* error)
-					{
-						auto unwrappedError = Unwrap(isolate, error->Exception);
-						error->Release();
-						isolate->ThrowException(unwrappedError);
-					}
-				},
-				localClosure.As<v8::Value>())));
-	});
-}
+protected:
+	virtual void Dispose() override
+	{
+		if (ExternalFinalizer != nullptr)
+			ExternalFinalizer(Owner);
+		delete this;
+	}
+};
 
-// --------------------------------------------------------------------------
-// String
-DllPublic JSString* CDecl CreateJSString(JSContext* context, const uint16_t* buffer, int length, JSRuntimeError* outError)
+template<typename TResource, typename TChar>
+static JSString* CreateExternalString(
+	JSContext* context,
+	const TChar* buffer,
+	int length,
+	void* owner,
+	JSRuntimeError* outError,
+	v8::MaybeLocal<v8::String> (*newExternal)(v8::Isolate*, TResource*))
 {
 	*outError = JSRuntimeError::NoError;
 	V8Scope scope(context);
-	auto mstr = v8::String::NewFromTwoByte(context->Isolate, buffer, v8::NewStringType::kNormal, length);
+	auto resource = new ExternalStringResource<TResource, TChar>(buffer, (size_t)length, context->ExternalFinalizer, owner);
+	auto mstr = newExternal(context->Isolate, resource);
 	if (mstr.IsEmpty())
 	{
+		// V8 did not take ownership of the resource
+		delete resource;
 		*outError = JSRuntimeError::StringTooLong;
 		return nullptr;
 	}
 	return new JSString(context->Isolate, mstr.ToLocalChecked());
 }
 
+DllPublic JSString* CDecl CreateExternalJSString(JSContext* context, const uint16_t* buffer, int length, void* owner, JSRuntimeError* outError)
+{
+	return CreateExternalString<v8::String::ExternalStringResource>(
+		context, buffer, length, owner, outError, &v8::String::NewExternalTwoByte);
+}
+
+DllPublic JSString* CDecl CreateExternalOneByteJSString(JSContext* context, const char* buffer, int length, void* owner, JSRuntimeError* outError)
+{
+	return CreateExternalString<v8::String::ExternalOneByteStringResource>(
+		context, buffer, length, owner, outError, &v8::String::NewExternalOneByte);
+}
+
 DllPublic int CDecl JSStringLength(JSContext* context, JSString* string)
 {
 	V8Scope scope(context);
@@ -771,6 +2257,43 @@ DllPublic void CDecl WriteJSStringBuffer(JSContext* context, JSString* string, u
 	string->LocalHandle(context)->Write(outBuffer, 0, -1, nullTerminate ? v8::String::NO_OPTIONS : v8::String::NO_NULL_TERMINATION);
 }
 
+DllPublic int CDecl ReadJSStringBuffer(JSContext* context, JSString* string, uint16_t* outBuffer, int capacity, bool* outIsOneByte)
+{
+	V8Scope scope(context);
+	auto str = string->LocalHandle(context);
+	*outIsOneByte = str->IsOneByte();
+	// V8 reads a negative length as no limit
+	if (capacity > 0)
+		str->Write(outBuffer, 0, capacity, v8::String::NO_NULL_TERMINATION);
+	return str->Length();
+}
+
+DllPublic int CDecl WriteJSStringUtf8(JSContext* context, JSString* string, char* outBuffer, int capacity)
+{
+	V8Scope scope(context);
+	auto str = string->LocalHandle(context);
+	int charsWritten = 0;
+	// V8 reads a negative capacity as no limit
+	int bytesWritten = capacity <= 0 ? 0 : str->WriteUtf8(
+		outBuffer,
+		capacity,
+		&charsWritten,
+		v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+	// Only measure the whole string when it didn't fit
+	return charsWritten < str->Length()
+		? str->Utf8Length()
+		: bytesWritten;
+}
+
+DllPublic int CDecl WriteJSStringOneByte(JSContext* context, JSString* string, uint8_t* outBuffer, int capacity)
+{
+	V8Scope scope(context);
+	auto str = string->LocalHandle(context);
+	if (capacity > 0)
+		str->WriteOneByte(outBuffer, 0, capacity, v8::String::NO_NULL_TERMINATION);
+	return str->Length();
+}
+
 DllPublic JSValue* CDecl JSStringAsValue(JSString* string) { return static_cast<JSValue*>(string); }
 
 // -------------------------------------------------------------------------
@@ -781,7 +2304,6 @@ DllPublic JSValue* CDecl CopyJSObjectProperty(JSContext* context, JSObject* obj,
 	{
 		return WrapMaybe(
 			context,
-			tryCatch,
 			obj->LocalHandle(context)->Get(
 				context->LocalHandle(),
 				key->LocalHandle(context)));
@@ -792,23 +2314,44 @@ DllPublic void CDecl SetJSObjectProperty(JSContext* context, JSObject* obj, JSSt
 {
 	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
 	{
-		FromJust(context, tryCatch, obj->LocalHandle(context)->Set(
+		IgnoreResult(obj->LocalHandle(context)->Set(
 			context->LocalHandle(),
 			key->LocalHandle(context),
 			Unwrap(context->Isolate, value)));
 	});
 }
 
+DllPublic int CDecl CopyJSObjectProperties(JSContext* context, JSObject* obj, JSString* const* keys, int numKeys, JSValue** outValues, JSScriptException** outErrors)
+{
+	return TryCatchEach(outErrors, context, numKeys, [&] (v8::TryCatch& tryCatch, int i)
+	{
+		outValues[i] = WrapMaybe(
+			context,
+			obj->LocalHandle(context)->Get(
+				context->LocalHandle(),
+				keys[i]->LocalHandle(context)));
+	});
+}
+
+DllPublic int CDecl SetJSObjectProperties(JSContext* context, JSObject* obj, JSString* const* keys, JSValue* const* values, int numKeys, JSScriptException** outErrors)
+{
+	return TryCatchEach(outErrors, context, numKeys, [&] (v8::TryCatch& tryCatch, int i)
+	{
+		IgnoreResult(obj->LocalHandle(context)->Set(
+			context->LocalHandle(),
+			keys[i]->LocalHandle(context),
+			Unwrap(context->Isolate, values[i])));
+	});
+}
+
 DllPublic JSArray* CDecl CopyJSObjectOwnPropertyNames(JSContext* context, JSObject* obj, JSScriptException** outError)
 {
-	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSArray*
 	{
-		return new JSArray(
-			context->Isolate,
-			FromJust(
-				context,
-				tryCatch,
-				obj->LocalHandle(context)->GetOwnPropertyNames(context->LocalHandle())));
+		v8::Local<v8::Array> names;
+		if (!obj->LocalHandle(context)->GetOwnPropertyNames(context->LocalHandle()).ToLocal(&names))
+			return nullptr;
+		return new JSArray(context->Isolate, names);
 	});
 }
 
@@ -816,10 +2359,9 @@ DllPublic bool CDecl JSObjectHasProperty(JSContext* context, JSObject* obj, JSSt
 {
 	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
 	{
-		return FromJust(
-			context,
-			tryCatch,
-			obj->LocalHandle(context)->Has(context->LocalHandle(), key->LocalHandle(context)));
+		return obj->LocalHandle(context)
+			->Has(context->LocalHandle(), key->LocalHandle(context))
+			.FromMaybe(false);
 	});
 }
 
@@ -836,32 +2378,308 @@ DllPublic void* CDecl GetJSObjectArrayBufferData(JSContext* context, JSObject* o
 	return localObj.As<v8::ArrayBuffer>()->GetContents().Data();
 }
 
-DllPublic JSValue* CDecl JSObjectAsValue(JSObject* obj) { return static_cast<JSValue*>(obj); }
+DllPublic int CDecl GetJSObjectArrayBufferByteLength(JSContext* context, JSObject* obj, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	auto localObj = obj->LocalHandle(context);
+	if (!localObj->IsArrayBuffer())
+	{
+		*outError = JSRuntimeError::TypeError;
+		return 0;
+	}
+	return static_cast<int>(localObj.As<v8::ArrayBuffer>()->ByteLength());
+}
+
+static size_t ElementSize(JSArrayBufferViewType type)
+{
+	switch (type)
+	{
+		case JSArrayBufferViewType::Int8Array:
+		case JSArrayBufferViewType::Uint8Array:
+		case JSArrayBufferViewType::Uint8ClampedArray:
+		case JSArrayBufferViewType::DataView:
+			return 1;
+		case JSArrayBufferViewType::Int16Array:
+		case JSArrayBufferViewType::Uint16Array:
+			return 2;
+		case JSArrayBufferViewType::Int32Array:
+		case JSArrayBufferViewType::Uint32Array:
+		case JSArrayBufferViewType::Float32Array:
+			return 4;
+		case JSArrayBufferViewType::Float64Array:
+			return 8;
+	}
+	return 0;
+}
+
+static v8::Local<v8::ArrayBufferView> NewArrayBufferView(
+	v8::Local<v8::ArrayBuffer> buffer,
+	JSArrayBufferViewType type,
+	size_t byteOffset,
+	size_t length)
+{
+	switch (type)
+	{
+		case JSArrayBufferViewType::Int8Array: return v8::Int8Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Uint8Array: return v8::Uint8Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Uint8ClampedArray: return v8::Uint8ClampedArray::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Int16Array: return v8::Int16Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Uint16Array: return v8::Uint16Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Int32Array: return v8::Int32Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Uint32Array: return v8::Uint32Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Float32Array: return v8::Float32Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::Float64Array: return v8::Float64Array::New(buffer, byteOffset, length);
+		case JSArrayBufferViewType::DataView: return v8::DataView::New(buffer, byteOffset, length);
+	}
+	return v8::Local<v8::ArrayBufferView>();
+}
+
+static JSArrayBufferViewType GetArrayBufferViewType(v8::Local<v8::ArrayBufferView> view)
+{
+	if (view->IsInt8Array()) return JSArrayBufferViewType::Int8Array;
+	if (view->IsUint8Array()) return JSArrayBufferViewType::Uint8Array;
+	if (view->IsUint8ClampedArray()) return JSArrayBufferViewType::Uint8ClampedArray;
+	if (view->IsInt16Array()) return JSArrayBufferViewType::Int16Array;
+	if (view->IsUint16Array()) return JSArrayBufferViewType::Uint16Array;
+	if (view->IsInt32Array()) return JSArrayBufferViewType::Int32Array;
+	if (view->IsUint32Array()) return JSArrayBufferViewType::Uint32Array;
+	if (view->IsFloat32Array()) return JSArrayBufferViewType::Float32Array;
+	if (view->IsFloat64Array()) return JSArrayBufferViewType::Float64Array;
+	return JSArrayBufferViewType::DataView;
+}
+
+static JSObject* CreateArrayBufferView(
+	JSContext* context,
+	v8::Local<v8::ArrayBuffer> buffer,
+	JSArrayBufferViewType type,
+	int byteOffset,
+	int length,
+	JSRuntimeError* outError)
+{
+	auto elementSize = ElementSize(type);
+	if (elementSize == 0)
+	{
+		*outError = JSRuntimeError::TypeError;
+		return nullptr;
+	}
+	if (byteOffset < 0
+		|| length < 0
+		|| byteOffset % elementSize != 0
+		|| (size_t)byteOffset + (size_t)length * elementSize > buffer->ByteLength())
+	{
+		*outError = JSRuntimeError::RangeError;
+		return nullptr;
+	}
+	return new JSObject(context->Isolate, NewArrayBufferView(buffer, type, (size_t)byteOffset, (size_t)length));
+}
+
+DllPublic JSObject* CDecl CreateJSArrayBufferView(JSContext* context, JSObject* arrayBuffer, JSArrayBufferViewType type, int byteOffset, int length, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	auto localBuffer = arrayBuffer->LocalHandle(context);
+	if (!localBuffer->IsArrayBuffer())
+	{
+		*outError = JSRuntimeError::TypeError;
+		return nullptr;
+	}
+	return CreateArrayBufferView(context, localBuffer.As<v8::ArrayBuffer>(), type, byteOffset, length, outError);
+}
+
+DllPublic JSObject* CDecl CreateExternalJSArrayBufferView(JSContext* context, JSArrayBufferViewType type, void* data, int length, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	auto byteLength = ElementSize(type) * (size_t)(length < 0 ? 0 : length);
+	return CreateArrayBufferView(
+		context,
+		v8::ArrayBuffer::New(context->Isolate, data, byteLength),
+		type,
+		0,
+		length,
+		outError);
+}
+
+DllPublic void* CDecl GetJSObjectArrayBufferViewData(JSContext* context, JSObject* obj, JSArrayBufferViewType* outType, int* outByteOffset, int* outByteLength, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	*outByteOffset = 0;
+	*outByteLength = 0;
+	V8Scope scope(context);
+	auto localObj = obj->LocalHandle(context);
+	if (!localObj->IsArrayBufferView())
+	{
+		*outError = JSRuntimeError::TypeError;
+		return nullptr;
+	}
+	auto view = localObj.As<v8::ArrayBufferView>();
+	*outType = GetArrayBufferViewType(view);
+	*outByteOffset = static_cast<int>(view->ByteOffset());
+	*outByteLength = static_cast<int>(view->ByteLength());
+	// Buffer() moves on-heap typed array data to a stable backing store
+	auto data = static_cast<uint8_t*>(view->Buffer()->GetContents().Data());
+	return data == nullptr ? nullptr : data + view->ByteOffset();
+}
+
+DllPublic JSObject* CDecl CopyJSObjectArrayBufferViewBuffer(JSContext* context, JSObject* obj, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	auto localObj = obj->LocalHandle(context);
+	if (!localObj->IsArrayBufferView())
+	{
+		*outError = JSRuntimeError::TypeError;
+		return nullptr;
+	}
+	return new JSObject(context->Isolate, localObj.As<v8::ArrayBufferView>()->Buffer());
+}
+
+DllPublic JSValue* CDecl JSObjectAsValue(JSObject* obj) { return static_cast<JSValue*>(obj); }
+
+// -------------------------------------------------------------------------
+// Array
+DllPublic JSValue* CDecl CopyJSArrayPropertyAtIndex(JSContext* context, JSArray* arr, int index, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		return WrapMaybe(
+			context,
+			arr->LocalHandle(context)->Get(context->LocalHandle(), index));
+	});
+}
+
+DllPublic void CDecl SetJSArrayPropertyAtIndex(JSContext* context, JSArray* arr, int index, JSValue* value, JSScriptException** outError)
+{
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		IgnoreResult(arr->LocalHandle(context)->Set(
+			context->LocalHandle(),
+			static_cast<uint32_t>(index),
+			Unwrap(context->Isolate, value)));
+	});
+}
+
+DllPublic void CDecl CopyJSArrayRange(JSContext* context, JSArray* arr, int start, int count, JSValue** outValues, JSScriptException** outError)
+{
+	for (int i = 0; i < count; ++i)
+		outValues[i] = nullptr;
+
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		auto localArr = arr->LocalHandle(context);
+		auto localContext = context->LocalHandle();
+		for (int i = 0; i < count; ++i)
+		{
+			v8::HandleScope handleScope(context->Isolate);
+			outValues[i] = WrapMaybe(
+				context,
+				localArr->Get(localContext, static_cast<uint32_t>(start + i)));
+			if (tryCatch.HasCaught())
+			{
+				for (int j = 0; j < i; ++j)
+				{
+					if (outValues[j] != nullptr)
+						outValues[j]->Release();
+					outValues[j] = nullptr;
+				}
+				return;
+			}
+		}
+	});
+}
+
+DllPublic void CDecl SetJSArrayRange(JSContext* context, JSArray* arr, int start, int count, JSValue* const* values, JSScriptException** outError)
+{
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		auto localArr = arr->LocalHandle(context);
+		auto localContext = context->LocalHandle();
+		for (int i = 0; i < count; ++i)
+		{
+			v8::HandleScope handleScope(context->Isolate);
+			if (localArr->Set(
+					localContext,
+					static_cast<uint32_t>(start + i),
+					Unwrap(context->Isolate, values[i])).IsNothing())
+				return;
+		}
+	});
+}
+
+DllPublic void CDecl CopyJSArrayDoubles(JSContext* context, JSArray* arr, int start, int count, double* outValues, JSScriptException** outError)
+{
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		auto localArr = arr->LocalHandle(context);
+		auto localContext = context->LocalHandle();
+		for (int i = 0; i < count; ++i)
+		{
+			v8::HandleScope handleScope(context->Isolate);
+			v8::Local<v8::Value> element;
+			if (!localArr->Get(localContext, static_cast<uint32_t>(start + i)).ToLocal(&element))
+				return;
+			if (element->IsNumber())
+				outValues[i] = element.As<v8::Number>()->Value();
+			else if (!element->NumberValue(localContext).To(&outValues[i]))
+				return;
+		}
+	});
+}
+
+DllPublic void CDecl SetJSArrayDoubles(JSContext* context, JSArray* arr, int start, int count, const double* values, JSScriptException** outError)
+{
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		auto localArr = arr->LocalHandle(context);
+		auto localContext = context->LocalHandle();
+		for (int i = 0; i < count; ++i)
+		{
+			v8::HandleScope handleScope(context->Isolate);
+			if (localArr->Set(
+					localContext,
+					static_cast<uint32_t>(start + i),
+					v8::Number::New(context->Isolate, values[i])).IsNothing())
+				return;
+		}
+	});
+}
 
-// -------------------------------------------------------------------------
-// Array
-DllPublic JSValue* CDecl CopyJSArrayPropertyAtIndex(JSContext* context, JSArray* arr, int index, JSScriptException** outError)
+DllPublic void CDecl CopyJSArrayInts(JSContext* context, JSArray* arr, int start, int count, int32_t* outValues, JSScriptException** outError)
 {
-	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
 	{
-		return WrapMaybe(
-			context,
-			tryCatch,
-			arr->LocalHandle(context)->Get(context->LocalHandle(), index));
+		auto localArr = arr->LocalHandle(context);
+		auto localContext = context->LocalHandle();
+		for (int i = 0; i < count; ++i)
+		{
+			v8::HandleScope handleScope(context->Isolate);
+			v8::Local<v8::Value> element;
+			if (!localArr->Get(localContext, static_cast<uint32_t>(start + i)).ToLocal(&element))
+				return;
+			if (element->IsInt32())
+				outValues[i] = element.As<v8::Int32>()->Value();
+			else if (!element->Int32Value(localContext).To(&outValues[i]))
+				return;
+		}
 	});
 }
 
-DllPublic void CDecl SetJSArrayPropertyAtIndex(JSContext* context, JSArray* arr, int index, JSValue* value, JSScriptException** outError)
+DllPublic void CDecl SetJSArrayInts(JSContext* context, JSArray* arr, int start, int count, const int32_t* values, JSScriptException** outError)
 {
-	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
 	{
-		FromJust(
-			context,
-			tryCatch,
-			arr->LocalHandle(context)->Set(
-				context->LocalHandle(),
-				static_cast<uint32_t>(index),
-				Unwrap(context->Isolate, value)));
+		auto localArr = arr->LocalHandle(context);
+		auto localContext = context->LocalHandle();
+		for (int i = 0; i < count; ++i)
+		{
+			v8::HandleScope handleScope(context->Isolate);
+			if (localArr->Set(
+					localContext,
+					static_cast<uint32_t>(start + i),
+					v8::Int32::New(context->Isolate, values[i])).IsNothing())
+				return;
+		}
 	});
 }
 
@@ -879,14 +2697,13 @@ DllPublic JSValue* CDecl CallJSFunctionCreate(JSContext* context, JSFunction* fu
 {
 	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
 	{
-		std::vector<v8::Local<v8::Value>> unwrappedArgs(numArgs);
+		SmallArray<v8::Local<v8::Value>> unwrappedArgs(numArgs);
 
 		for (int i = 0; i < numArgs; ++i)
 			unwrappedArgs[i] = Unwrap(context->Isolate, args[i]);
 
 		return WrapMaybe(
 			context,
-			tryCatch,
 			function->LocalHandle(context)->Call(
 				context->LocalHandle(),
 				Unwrap(context->Isolate, thisObject),
@@ -896,26 +2713,170 @@ DllPublic JSValue* CDecl CallJSFunctionCreate(JSContext* context, JSFunction* fu
 	});
 }
 
+DllPublic int CDecl CallJSFunctionBatch(JSContext* context, JSFunction* function, JSObject* thisObject, JSValue* const* args, int argsPerCall, int numCalls, JSValue** outResults, JSScriptException** outErrors)
+{
+	if (argsPerCall < 0 || numCalls < 0)
+		return -1;
+	SmallArray<v8::Local<v8::Value>> unwrappedArgs(argsPerCall);
+	return TryCatchEach(outErrors, context, numCalls, [&] (v8::TryCatch& tryCatch, int i)
+	{
+		auto callArgs = args + static_cast<ptrdiff_t>(i) * argsPerCall;
+		for (int j = 0; j < argsPerCall; ++j)
+			unwrappedArgs[j] = Unwrap(context->Isolate, callArgs[j]);
+
+		outResults[i] = WrapMaybe(
+			context,
+			function->LocalHandle(context)->Call(
+				context->LocalHandle(),
+				Unwrap(context->Isolate, thisObject),
+				argsPerCall,
+				data_ptr(unwrappedArgs)));
+	});
+}
+
 DllPublic JSObject* CDecl ConstructJSFunctionCreate(JSContext* context, JSFunction* function, JSValue* const* args, int numArgs, JSScriptException** outError)
 {
-	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSObject*
 	{
-		std::vector<v8::Local<v8::Value>> unwrappedArgs(numArgs);
+		SmallArray<v8::Local<v8::Value>> unwrappedArgs(numArgs);
 
 		for (int i = 0; i < numArgs; ++i)
 			unwrappedArgs[i] = Unwrap(context->Isolate, args[i]);
 
-		return new JSObject(
-			context->Isolate,
-			FromJust(context, tryCatch, function->LocalHandle(context)->NewInstance(
+		v8::Local<v8::Object> instance;
+		if (!function->LocalHandle(context)->NewInstance(
 				context->LocalHandle(),
 				numArgs,
-				data_ptr(unwrappedArgs))));
+				data_ptr(unwrappedArgs)).ToLocal(&instance))
+			return nullptr;
+		return new JSObject(context->Isolate, instance);
 	});
 }
 
 DllPublic JSValue* CDecl JSFunctionAsValue(JSFunction* fun) { return static_cast<JSValue*>(fun); }
 
+// -------------------------------------------------------------------------
+// Unboxed
+DllPublic void CDecl CallJSFunctionUnboxed(JSContext* context, JSFunction* function, JSObject* thisObject, const JSValueUnboxed* args, int numArgs, JSValueUnboxed* outResult, JSScriptException** outError)
+{
+	outResult->Type = JSType::Null;
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		SmallArray<v8::Local<v8::Value>> unwrappedArgs(numArgs);
+
+		for (int i = 0; i < numArgs; ++i)
+			unwrappedArgs[i] = UnwrapUnboxed(context->Isolate, args[i]);
+
+		v8::Local<v8::Value> result;
+		if (!function->LocalHandle(context)->Call(
+				context->LocalHandle(),
+				Unwrap(context->Isolate, thisObject),
+				numArgs,
+				data_ptr(unwrappedArgs)).ToLocal(&result))
+			return;
+		WrapUnboxed(context, result, outResult);
+	});
+}
+
+DllPublic void CDecl CopyJSObjectPropertyUnboxed(JSContext* context, JSObject* obj, JSString* key, JSValueUnboxed* outValue, JSScriptException** outError)
+{
+	outValue->Type = JSType::Null;
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		v8::Local<v8::Value> value;
+		if (!obj->LocalHandle(context)->Get(
+				context->LocalHandle(),
+				key->LocalHandle(context)).ToLocal(&value))
+			return;
+		WrapUnboxed(context, value, outValue);
+	});
+}
+
+DllPublic void CDecl SetJSObjectPropertyUnboxed(JSContext* context, JSObject* obj, JSString* key, const JSValueUnboxed* value, JSScriptException** outError)
+{
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		IgnoreResult(obj->LocalHandle(context)->Set(
+			context->LocalHandle(),
+			key->LocalHandle(context),
+			UnwrapUnboxed(context->Isolate, *value)));
+	});
+}
+
+// Throws error in JS unless it is null, and releases it
+static void ThrowUnboxed(v8::Isolate* isolate, const JSValueUnboxed& error)
+{
+	if (error.Type != JSType::Null)
+	{
+		auto unwrappedError = UnwrapUnboxed(isolate, error);
+		ReleaseUnboxed(error);
+		isolate->ThrowException(unwrappedError);
+	}
+}
+
+// Calls call(args, numArgs, &result, &error) with the arguments of info
+// unboxed, and hands the result or error back to JS
+template<typename T>
+static void InvokeUnboxed(const v8::FunctionCallbackInfo<v8::Value>& info, JSContext* context, T call)
+{
+	struct AutoReleaser
+	{
+		const SmallArray<JSValueUnboxed>& _values;
+
+		~AutoReleaser()
+		{
+			for (auto& v : _values)
+				ReleaseUnboxed(v);
+		}
+	};
+
+	auto isolate = info.GetIsolate();
+	v8::HandleScope handleScope(isolate);
+
+	auto numArgs = info.Length();
+	SmallArray<JSValueUnboxed> args(numArgs);
+	AutoReleaser autoRelease{args};
+
+	for (int i = 0; i < numArgs; ++i)
+		WrapUnboxed(context, info[i], &args[i]);
+
+	JSValueUnboxed result;
+	result.Type = JSType::Null;
+	JSValueUnboxed error;
+	error.Type = JSType::Null;
+	call(data_ptr(args), numArgs, &result, &error);
+
+	info.GetReturnValue().Set(UnwrapUnboxed(isolate, result));
+	ReleaseUnboxed(result);
+	ThrowUnboxed(isolate, error);
+}
+
+DllPublic JSFunction* CDecl CreateJSUnboxedCallback(JSContext* context, void* data, JSUnboxedCallback callback, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSFunction*
+	{
+		auto localClosure = Closure<JSUnboxedCallback>::New(context, data, callback);
+
+		v8::Local<v8::Function> function;
+		if (!v8::Function::New(
+				context->LocalHandle(),
+				[] (const v8::FunctionCallbackInfo<v8::Value>& info)
+				{
+					auto closure = Closure<JSUnboxedCallback>::FromData(info.Data());
+					auto context = JSContext::FromCurrentOrThrow(info.GetIsolate());
+					if (context == nullptr)
+						return;
+					InvokeUnboxed(info, context, [&] (const JSValueUnboxed* args, int numArgs, JSValueUnboxed* result, JSValueUnboxed* error)
+					{
+						closure->callback(context, closure->data, args, numArgs, result, error);
+					});
+				},
+				localClosure.As<v8::Value>()).ToLocal(&function))
+			return nullptr;
+		return new JSFunction(context->Isolate, function);
+	});
+}
+
 // -------------------------------------------------------------------------
 // External
 DllPublic JSExternal* CDecl CreateJSExternal(JSContext* context, void* value)
@@ -957,6 +2918,311 @@ DllPublic void* CDecl GetJSExternalValue(JSContext* context, JSExternal* externa
 
 DllPublic JSValue* CDecl JSExternalAsValue(JSExternal* external) { return static_cast<JSValue*>(external); }
 
+// -------------------------------------------------------------------------
+// NativeClass
+struct JSClass : RefCounted
+{
+	static const int InstanceField = 0;
+
+	v8::Isolate* const Isolate;
+	// The template is per isolate, but its function is per context
+	const ResettingPersistent<v8::Context> OwnerContext;
+	ResettingPersistent<v8::FunctionTemplate> Template;
+	// Created on first use, which freezes the template
+	ResettingPersistent<v8::Function> Constructor;
+
+	JSClass(JSContext* owner, const v8::Local<v8::FunctionTemplate>& handle)
+		: Isolate(owner->Isolate)
+		, OwnerContext(owner->Handle)
+		, Template(owner->Isolate, handle)
+	{
+	}
+
+	inline v8::Local<v8::FunctionTemplate> LocalTemplate() { return Template.Get(Isolate); }
+	inline bool IsFrozen() const { return !Constructor.IsEmpty(); }
+
+	// Needs a HandleScope
+	inline bool BelongsTo(JSContext* context)
+	{
+		return context->Isolate == Isolate
+			&& OwnerContext.Get(Isolate) == context->LocalHandle();
+	}
+
+	// Throws a TypeError for the script exception reporting calls
+	bool CheckContext(JSContext* context)
+	{
+		if (BelongsTo(context))
+			return true;
+		Isolate->ThrowException(v8::Exception::TypeError(
+			v8::String::NewFromUtf8(
+				Isolate,
+				"Native class used from another context",
+				v8::NewStringType::kNormal).ToLocalChecked()));
+		return false;
+	}
+
+	bool GetConstructor(JSContext* context, v8::Local<v8::Function>* out)
+	{
+		if (!Constructor.IsEmpty())
+		{
+			*out = Constructor.Get(Isolate);
+			return true;
+		}
+		if (!LocalTemplate()->GetFunction(context->LocalHandle()).ToLocal(out))
+			return false;
+		Constructor.Reset(Isolate, *out);
+		return true;
+	}
+};
+
+DllPublic void CDecl RetainJSClass(JSContext* context, JSClass* cls)
+{
+	if (cls != nullptr)
+		cls->Retain();
+}
+
+DllPublic void CDecl ReleaseJSClass(JSContext* context, JSClass* cls)
+{
+	if (cls != nullptr)
+	{
+		v8::Locker locker(cls->Isolate);
+		cls->Release();
+	}
+}
+
+DllPublic JSClass* CDecl CreateJSClass(JSContext* context, JSString* name)
+{
+	V8Scope scope(context);
+	// Objects constructed from JS get a null instance pointer
+	auto localTemplate = v8::FunctionTemplate::New(
+		context->Isolate,
+		[] (const v8::FunctionCallbackInfo<v8::Value>& info)
+		{
+			if (info.IsConstructCall())
+				info.This()->SetAlignedPointerInInternalField(JSClass::InstanceField, nullptr);
+		});
+	localTemplate->SetClassName(name->LocalHandle(context));
+	localTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+	return new JSClass(context, localTemplate);
+}
+
+DllPublic void CDecl AddJSClassMethod(JSContext* context, JSClass* cls, JSString* name, void* data, JSMethodCallback callback, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	if (!cls->BelongsTo(context))
+	{
+		*outError = JSRuntimeError::WrongContext;
+		return;
+	}
+	if (cls->IsFrozen())
+	{
+		*outError = JSRuntimeError::TypeError;
+		return;
+	}
+	auto localTemplate = cls->LocalTemplate();
+	auto localClosure = Closure<JSMethodCallback>::New(context, data, callback);
+	// The signature makes V8 reject receivers that are not instances
+	auto method = v8::FunctionTemplate::New(
+		context->Isolate,
+		[] (const v8::FunctionCallbackInfo<v8::Value>& info)
+		{
+			auto closure = Closure<JSMethodCallback>::FromData(info.Data());
+			auto context = JSContext::FromCurrentOrThrow(info.GetIsolate());
+			if (context == nullptr)
+				return;
+			auto instance = info.Holder()->GetAlignedPointerFromInternalField(JSClass::InstanceField);
+			InvokeUnboxed(info, context, [&] (const JSValueUnboxed* args, int numArgs, JSValueUnboxed* result, JSValueUnboxed* error)
+			{
+				closure->callback(context, closure->data, instance, args, numArgs, result, error);
+			});
+		},
+		localClosure.As<v8::Value>(),
+		v8::Signature::New(context->Isolate, localTemplate));
+	localTemplate->PrototypeTemplate()->Set(name->LocalHandle(context), method);
+}
+
+DllPublic JSObject* CDecl CreateJSClassInstance(JSContext* context, JSClass* cls, void* instance, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSObject*
+	{
+		if (!cls->CheckContext(context))
+			return nullptr;
+		if ((reinterpret_cast<uintptr_t>(instance) & 1) != 0)
+		{
+			context->Isolate->ThrowException(v8::Exception::RangeError(
+				v8::String::NewFromUtf8(
+					context->Isolate,
+					"Native class instances must be 2-byte aligned",
+					v8::NewStringType::kNormal).ToLocalChecked()));
+			return nullptr;
+		}
+
+		v8::Local<v8::Function> constructor;
+		v8::Local<v8::Object> localObject;
+		if (!cls->GetConstructor(context, &constructor)
+			|| !constructor->NewInstance(context->LocalHandle()).ToLocal(&localObject))
+			return nullptr;
+		localObject->SetAlignedPointerInInternalField(JSClass::InstanceField, instance);
+
+		struct Closure
+		{
+			ResettingPersistent<v8::Object> finalizer;
+			JSExternalFinalizer externalFinalizer;
+			void* instance;
+		};
+
+		auto closure = new Closure{{}, context->ExternalFinalizer, instance};
+		closure->finalizer.Reset(context->Isolate, localObject);
+
+		closure->finalizer.SetWeak(
+			closure,
+			[] (const v8::WeakCallbackInfo<Closure>& data)
+			{
+				auto closure = data.GetParameter();
+				if (closure->externalFinalizer != nullptr)
+					closure->externalFinalizer(closure->instance);
+				closure->finalizer.Reset();
+				delete closure;
+			},
+			v8::WeakCallbackType::kParameter);
+
+		return new JSObject(context->Isolate, localObject);
+	});
+}
+
+DllPublic void* CDecl GetJSClassInstance(JSContext* context, JSClass* cls, JSObject* obj, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	if (!cls->BelongsTo(context))
+	{
+		*outError = JSRuntimeError::WrongContext;
+		return nullptr;
+	}
+	auto localObject = obj->LocalHandle(context);
+	if (!cls->LocalTemplate()->HasInstance(localObject))
+	{
+		*outError = JSRuntimeError::InvalidCast;
+		return nullptr;
+	}
+	return localObject->GetAlignedPointerFromInternalField(JSClass::InstanceField);
+}
+
+DllPublic JSFunction* CDecl GetJSClassConstructor(JSContext* context, JSClass* cls, JSScriptException** outError)
+{
+	return TryCatch(outError, context, [&] (v8::TryCatch& tryCatch) -> JSFunction*
+	{
+		v8::Local<v8::Function> constructor;
+		if (!cls->CheckContext(context)
+			|| !cls->GetConstructor(context, &constructor))
+			return nullptr;
+		return new JSFunction(context->Isolate, constructor);
+	});
+}
+
+// -------------------------------------------------------------------------
+// Accessors
+struct JSAccessorCallbacks
+{
+	JSGetterCallback Getter;
+	JSSetterCallback Setter;
+};
+
+typedef Closure<JSAccessorCallbacks> AccessorClosure;
+
+// Instances of native classes pass their pointer on to the accessors
+template<bool IsClassInstance>
+static inline void* HolderInstance(v8::Local<v8::Object> holder)
+{
+	return IsClassInstance
+		? holder->GetAlignedPointerFromInternalField(JSClass::InstanceField)
+		: nullptr;
+}
+
+template<bool IsClassInstance>
+static void AccessorGetter(v8::Local<v8::Name>, const v8::PropertyCallbackInfo<v8::Value>& info)
+{
+	auto isolate = info.GetIsolate();
+	v8::HandleScope handleScope(isolate);
+	auto closure = AccessorClosure::FromData(info.Data());
+	auto context = JSContext::FromCurrentOrThrow(isolate);
+	if (context == nullptr)
+		return;
+
+	JSValueUnboxed result;
+	result.Type = JSType::Null;
+	JSValueUnboxed error;
+	error.Type = JSType::Null;
+	closure->callback.Getter(context, closure->data, HolderInstance<IsClassInstance>(info.Holder()), &result, &error);
+
+	info.GetReturnValue().Set(UnwrapUnboxed(isolate, result));
+	ReleaseUnboxed(result);
+	ThrowUnboxed(isolate, error);
+}
+
+template<bool IsClassInstance>
+static void AccessorSetter(v8::Local<v8::Name>, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void>& info)
+{
+	auto isolate = info.GetIsolate();
+	v8::HandleScope handleScope(isolate);
+	auto closure = AccessorClosure::FromData(info.Data());
+
+	auto context = JSContext::FromCurrentOrThrow(isolate);
+	if (context == nullptr)
+		return;
+
+	JSValueUnboxed unboxedValue;
+	WrapUnboxed(context, value, &unboxedValue);
+	JSValueUnboxed error;
+	error.Type = JSType::Null;
+	closure->callback.Setter(context, closure->data, HolderInstance<IsClassInstance>(info.Holder()), &unboxedValue, &error);
+	ReleaseUnboxed(unboxedValue);
+	ThrowUnboxed(isolate, error);
+}
+
+DllPublic void CDecl SetJSObjectAccessor(JSContext* context, JSObject* obj, JSString* name, void* data, JSGetterCallback getter, JSSetterCallback setter, JSScriptException** outError)
+{
+	TryCatch(outError, context, [&] (v8::TryCatch& tryCatch)
+	{
+		auto localClosure = AccessorClosure::New(context, data, JSAccessorCallbacks{getter, setter});
+		IgnoreResult(obj->LocalHandle(context)->SetAccessor(
+			context->LocalHandle(),
+			name->LocalHandle(context),
+			&AccessorGetter<false>,
+			setter == nullptr ? nullptr : &AccessorSetter<false>,
+			localClosure.As<v8::Value>(),
+			v8::DEFAULT,
+			setter == nullptr ? v8::ReadOnly : v8::None));
+	});
+}
+
+DllPublic void CDecl AddJSClassAccessor(JSContext* context, JSClass* cls, JSString* name, void* data, JSGetterCallback getter, JSSetterCallback setter, JSRuntimeError* outError)
+{
+	*outError = JSRuntimeError::NoError;
+	V8Scope scope(context);
+	if (!cls->BelongsTo(context))
+	{
+		*outError = JSRuntimeError::WrongContext;
+		return;
+	}
+	if (cls->IsFrozen())
+	{
+		*outError = JSRuntimeError::TypeError;
+		return;
+	}
+	auto localTemplate = cls->LocalTemplate();
+	auto localClosure = AccessorClosure::New(context, data, JSAccessorCallbacks{getter, setter});
+	localTemplate->InstanceTemplate()->SetAccessor(
+		name->LocalHandle(context).As<v8::Name>(),
+		&AccessorGetter<true>,
+		setter == nullptr ? nullptr : &AccessorSetter<true>,
+		localClosure.As<v8::Value>(),
+		v8::DEFAULT,
+		setter == nullptr ? v8::ReadOnly : v8::None,
+		v8::AccessorSignature::New(context->Isolate, localTemplate));
+}
+
 // -------------------------------------------------------------------------
 // Exceptions
 DllPublic void CDecl RetainJSScriptException(JSContext* context, JSScriptException* e)
@@ -975,10 +3241,120 @@ DllPublic void CDecl ReleaseJSScriptException(JSContext* context, JSScriptExcept
 		e->Release();
 	}
 }
-DllPublic JSValue* CDecl GetJSScriptException(JSScriptException* e) { return e->Exception; }
-DllPublic JSString* CDecl GetJSScriptExceptionMessage(JSScriptException* e) { return e->ErrorMessage; }
-DllPublic JSString* CDecl GetJSScriptExceptionFileName(JSScriptException* e) { return e->FileName; }
-DllPublic int CDecl GetJSScriptExceptionLineNumber(JSScriptException* e) { return e->LineNumber; }
-DllPublic JSString* CDecl GetJSScriptExceptionStackTrace(JSScriptException* e) { return e->StackTrace; }
-DllPublic JSString* CDecl GetJSScriptExceptionSourceLine(JSScriptException* e) { return e->SourceLine; }
+
+JSValue* JSScriptException::LazyException()
+{
+	V8Scope scope(Context);
+	if (!HasException)
+	{
+		if (!ExceptionHandle.IsEmpty())
+			Exception = Wrap(Context, ExceptionHandle.Get(Context->Isolate));
+		HasException = true;
+	}
+	return Exception;
+}
+
+JSString* JSScriptException::LazyMessage()
+{
+	V8Scope scope(Context);
+	if (ErrorMessage == nullptr)
+	{
+		v8::Local<v8::String> messageStr = v8::String::Empty(Context->Isolate);
+		if (!MessageHandle.IsEmpty())
+		{
+			auto messageStrLocal = LocalMessage()->Get();
+			if (!messageStrLocal.IsEmpty())
+				messageStr = messageStrLocal;
+		}
+		ErrorMessage = new JSString(Context->Isolate, messageStr);
+	}
+	return ErrorMessage;
+}
+
+JSString* JSScriptException::LazyFileName()
+{
+	V8Scope scope(Context);
+	if (FileName == nullptr)
+	{
+		v8::Local<v8::String> emptyString = v8::String::Empty(Context->Isolate);
+		v8::Local<v8::String> fileName(emptyString);
+		if (!MessageHandle.IsEmpty())
+		{
+			fileName = LocalMessage()
+				->GetScriptResourceName()
+				->ToString(Context->LocalHandle())
+				.FromMaybe(emptyString);
+		}
+		FileName = new JSString(Context->Isolate, fileName);
+	}
+	return FileName;
+}
+
+int JSScriptException::LazyLineNumber()
+{
+	V8Scope scope(Context);
+	if (!HasLineNumber)
+	{
+		if (!MessageHandle.IsEmpty())
+			LineNumber = LocalMessage()->GetLineNumber(Context->LocalHandle()).FromMaybe(-1);
+		HasLineNumber = true;
+	}
+	return LineNumber;
+}
+
+JSString* JSScriptException::LazyStackTrace()
+{
+	V8Scope scope(Context);
+	if (StackTrace == nullptr)
+	{
+		// Same as v8::TryCatch::StackTrace, which needs the live TryCatch
+		v8::Local<v8::String> emptyString = v8::String::Empty(Context->Isolate);
+		v8::Local<v8::String> stackTrace(emptyString);
+		if (!ExceptionHandle.IsEmpty())
+		{
+			auto exception = ExceptionHandle.Get(Context->Isolate);
+			if (exception->IsObject())
+			{
+				v8::TryCatch tryCatch;
+				auto localContext = Context->LocalHandle();
+				auto obj = exception.As<v8::Object>();
+				auto stackKey = v8::String::NewFromUtf8(
+					Context->Isolate,
+					"stack",
+					v8::NewStringType::kInternalized).ToLocalChecked();
+				if (obj->HasRealNamedProperty(localContext, stackKey).FromMaybe(false))
+				{
+					stackTrace = obj
+						->Get(localContext, stackKey)
+						.FromMaybe(emptyString.As<v8::Value>())
+						->ToString(localContext)
+						.FromMaybe(emptyString);
+				}
+			}
+		}
+		StackTrace = new JSString(Context->Isolate, stackTrace);
+	}
+	return StackTrace;
+}
+
+JSString* JSScriptException::LazySourceLine()
+{
+	V8Scope scope(Context);
+	if (SourceLine == nullptr)
+	{
+		v8::Local<v8::String> emptyString = v8::String::Empty(Context->Isolate);
+		v8::Local<v8::String> sourceLine(emptyString);
+		if (!MessageHandle.IsEmpty())
+			sourceLine = LocalMessage()->GetSourceLine(Context->LocalHandle()).FromMaybe(emptyString);
+		SourceLine = new JSString(Context->Isolate, sourceLine);
+	}
+	return SourceLine;
+}
+
+DllPublic JSValue* CDecl GetJSScriptException(JSScriptException* e) { return e->LazyException(); }
+DllPublic JSString* CDecl GetJSScriptExceptionMessage(JSScriptException* e) { return e->LazyMessage(); }
+DllPublic JSString* CDecl GetJSScriptExceptionFileName(JSScriptException* e) { return e->LazyFileName(); }
+DllPublic int CDecl GetJSScriptExceptionLineNumber(JSScriptException* e) { return e->LazyLineNumber(); }
+DllPublic JSString* CDecl GetJSScriptExceptionStackTrace(JSScriptException* e) { return e->LazyStackTrace(); }
+DllPublic JSString* CDecl GetJSScriptExceptionSourceLine(JSScriptException* e) { return e->LazySourceLine(); }
 /// }
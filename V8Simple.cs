@@ -17,12 +17,106 @@ public enum JSType
 	Function,
 	External,
 }
+public enum JSNativeType
+{
+	Void,
+	Int,
+	Double,
+	Bool,
+}
 public enum JSRuntimeError
 {
 	NoError,
 	InvalidCast,
 	StringTooLong,
 	TypeError,
+	ScriptError,
+	SnapshotError,
+	RangeError,
+	WrongContext,
+	ShutDown,
+	AlreadyInitialized,
+}
+public enum JSArrayBufferViewType
+{
+	Int8Array,
+	Uint8Array,
+	Uint8ClampedArray,
+	Int16Array,
+	Uint16Array,
+	Int32Array,
+	Uint32Array,
+	Float32Array,
+	Float64Array,
+	DataView,
+}
+public enum JSArrayBufferAllocatorType
+{
+	Malloc,
+	Pooled,
+}
+public enum JSHeapLimitPolicy
+{
+	Default,
+	TerminateExecution,
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSIsolateOptions
+{
+	public int MaxSemiSpaceSizeMB;
+	public int MaxOldSpaceSizeMB;
+	public int CodeRangeSizeMB;
+	public int StackLimitKB;
+	public JSArrayBufferAllocatorType AllocatorType;
+	public JSHeapLimitPolicy HeapLimitPolicy;
+	public int HeapLimitPercent;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSHeapStatistics
+{
+	public long TotalHeapSize;
+	public long UsedHeapSize;
+	public long HeapSizeLimit;
+	public long HeapLimitTerminations;
+	public long ExternalMemory;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSPlatformOptions
+{
+	public int WorkerThreads;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSTypedSignature
+{
+	public const int MaxArgs = 4;
+	public JSNativeType ReturnType;
+	public int NumArgs;
+	[MarshalAs(UnmanagedType.ByValArray, SizeConst = MaxArgs)]
+	public JSNativeType[] ArgTypes;
+	public JSTypedSignature(JSNativeType returnType, params JSNativeType[] argTypes)
+	{
+		ReturnType = returnType;
+		NumArgs = argTypes.Length;
+		ArgTypes = new JSNativeType[MaxArgs];
+		Array.Copy(argTypes, ArgTypes, Math.Min(argTypes.Length, MaxArgs));
+	}
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSArrayBufferAllocatorStatistics
+{
+	public long LiveBytes;
+	public long PeakBytes;
+	public long PoolHits;
+	public long PoolMisses;
+	public double PoolHitRate { get { return PoolHits + PoolMisses == 0 ? 0.0 : (double)PoolHits / (PoolHits + PoolMisses); } }
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSIsolatePoolStatistics
+{
+	public long Hits;
+	public long Misses;
+	public long Idle;
+	public double HitRate { get { return Hits + Misses == 0 ? 0.0 : (double)Hits / (Hits + Misses); } }
 }
 [StructLayout(LayoutKind.Sequential)]
 public struct JSContext
@@ -68,11 +162,72 @@ public struct JSScriptException
 	public static bool operator ==(JSScriptException e1, JSScriptException e2) { return e1._handle == e2._handle; }
 	public static bool operator !=(JSScriptException e1, JSScriptException e2) { return e1._handle != e2._handle; }
 }
+[StructLayout(LayoutKind.Sequential)]
+public struct JSCodeCache
+{
+	readonly IntPtr _handle;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSScript
+{
+	readonly IntPtr _handle;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSSnapshot
+{
+	readonly IntPtr _handle;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSIsolatePool
+{
+	readonly IntPtr _handle;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSIsolate
+{
+	readonly IntPtr _handle;
+}
+[StructLayout(LayoutKind.Sequential)]
+public struct JSClass
+{
+	readonly IntPtr _handle;
+}
+[StructLayout(LayoutKind.Explicit, Size = 16)]
+public struct JSValueUnboxed
+{
+	[FieldOffset(0)] public JSType Type;
+	[FieldOffset(8)] public int Int;
+	[FieldOffset(8)] public double Double;
+	[FieldOffset(8)] byte _bool;
+	[FieldOffset(8)] public JSValue Handle;
+	public bool Bool { get { return _bool != 0; } set { _bool = value ? (byte)1 : (byte)0; } }
+	public static JSValueUnboxed FromInt(int value) { var result = new JSValueUnboxed(); result.Type = JSType.Int; result.Int = value; return result; }
+	public static JSValueUnboxed FromDouble(double value) { var result = new JSValueUnboxed(); result.Type = JSType.Double; result.Double = value; return result; }
+	public static JSValueUnboxed FromBool(bool value) { var result = new JSValueUnboxed(); result.Type = JSType.Bool; result.Bool = value; return result; }
+	public static JSValueUnboxed FromValue(JSValue value) { var result = new JSValueUnboxed(); result.Type = Value.GetType(value); result.Handle = value; return result; }
+}
 public delegate JSValue JSCallback(JSContext context, IntPtr data, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] args, int numArgs, out JSValue error);
 public delegate void JSExternalFinalizer(IntPtr external);
 public delegate void JSCallbackFinalizer(IntPtr data);
+public delegate void JSUnboxedCallback(JSContext context, IntPtr data, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error);
+public delegate void JSMethodCallback(JSContext context, IntPtr data, IntPtr instance, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error);
+public delegate void JSGetterCallback(JSContext context, IntPtr data, IntPtr instance, out JSValueUnboxed result, out JSValueUnboxed error);
+public delegate void JSSetterCallback(JSContext context, IntPtr data, IntPtr instance, [In] ref JSValueUnboxed value, out JSValueUnboxed error);
 public delegate void JSDebugMessageHandler(IntPtr data, JSString message);
 // -------------------------------------------------------------------------
+// Platform
+public static class Platform
+{
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="InitializeV8Simple")]
+public static extern void Initialize([In] ref JSPlatformOptions options, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetV8SimplePlatformOptions")]
+[return: MarshalAs(UnmanagedType.I1)]
+public static extern bool GetOptions(out JSPlatformOptions options);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ShutdownV8Simple")]
+[return: MarshalAs(UnmanagedType.I1)]
+public static extern bool Shutdown();
+}
+// -------------------------------------------------------------------------
 // Context
 public static class Context
 {
@@ -82,8 +237,24 @@ public static extern void Retain(JSContext context);
 public static extern void Release(JSContext context);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContext")]
 public static extern JSContext Create([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextFromSnapshot")]
+public static extern JSContext CreateFromSnapshot([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]byte[] snapshot, int snapshotLength, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextWithArrayBufferAllocator")]
+public static extern JSContext CreateWithArrayBufferAllocator([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer, JSArrayBufferAllocatorType allocatorType);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextWithOptions")]
+public static extern JSContext CreateWithOptions([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer, [In] ref JSIsolateOptions options, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSContextIsolate")]
+public static extern JSIsolate GetIsolate(JSContext context);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSContextArrayBufferAllocatorStatistics")]
+public static extern void GetArrayBufferAllocatorStatistics(JSContext context, out JSArrayBufferAllocatorStatistics statistics);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSContextEvaluateCreate")]
 public static extern JSValue EvaluateCreate(JSContext context, JSString fileName, JSString code, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSContextEvaluateCachedCreate")]
+public static extern JSValue EvaluateCachedCreate(JSContext context, JSString fileName, JSString code, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]byte[] cache, int cacheLength, out JSCodeCache outCache, [MarshalAs(UnmanagedType.I1)]out bool outCacheRejected, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="EnterJSContextScope")]
+public static extern void EnterScope(JSContext context);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ExitJSContextScope")]
+public static extern void ExitScope(JSContext context, out JSRuntimeError error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSContextCopyGlobalObject")]
 public static extern JSObject CopyGlobalObject(JSContext context);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetV8Version")]
@@ -91,6 +262,110 @@ public static extern IntPtr GetV8VersionPtr();
 public static string GetV8Version() { return Marshal.PtrToStringAnsi(GetV8VersionPtr()); }
 }
 // -------------------------------------------------------------------------
+// Code cache
+public static class CodeCache
+{
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSCodeCache")]
+public static extern void Release(JSCodeCache cache);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSCodeCacheData")]
+public static extern IntPtr GetData(JSCodeCache cache);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSCodeCacheLength")]
+public static extern int GetLength(JSCodeCache cache);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSCodeCacheVersionTag")]
+public static extern uint GetVersionTag();
+public static byte[] ToArray(JSCodeCache cache)
+{
+	var result = new byte[GetLength(cache)];
+	Marshal.Copy(GetData(cache), result, 0, result.Length);
+	return result;
+}
+}
+// -------------------------------------------------------------------------
+// Snapshot
+public static class Snapshot
+{
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSSnapshot")]
+public static extern JSSnapshot Create([MarshalAs(UnmanagedType.LPWStr, SizeParamIndex = 1)]string code, int codeLength, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSSnapshot")]
+public static extern void Release(JSSnapshot snapshot);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSSnapshotData")]
+public static extern IntPtr GetData(JSSnapshot snapshot);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSSnapshotLength")]
+public static extern int GetLength(JSSnapshot snapshot);
+public static byte[] ToArray(JSSnapshot snapshot)
+{
+	var result = new byte[GetLength(snapshot)];
+	Marshal.Copy(GetData(snapshot), result, 0, result.Length);
+	return result;
+}
+}
+// -------------------------------------------------------------------------
+// Isolate
+public static class Isolate
+{
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSIsolate")]
+public static extern JSIsolate Create([In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 1)]byte[] snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSIsolateWithOptions")]
+public static extern JSIsolate CreateWithOptions([In] ref JSIsolateOptions options, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 2)]byte[] snapshot, int snapshotLength, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSIsolateHeapStatistics")]
+public static extern void GetHeapStatistics(JSIsolate isolate, out JSHeapStatistics statistics);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSIsolate")]
+public static extern void Retain(JSIsolate isolate);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSIsolate")]
+public static extern void Release(JSIsolate isolate);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextInIsolate")]
+public static extern JSContext CreateContext(JSIsolate isolate, [MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer);
+}
+// -------------------------------------------------------------------------
+// IsolatePool
+public static class IsolatePool
+{
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSIsolatePool")]
+public static extern JSIsolatePool Create(int size, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 2)]byte[] snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSIsolatePool")]
+public static extern void Retain(JSIsolatePool pool);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSIsolatePool")]
+public static extern void Release(JSIsolatePool pool);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextFromIsolatePool")]
+public static extern JSContext CreateContext(JSIsolatePool pool, [MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSIsolatePoolStatistics")]
+public static extern void GetStatistics(JSIsolatePool pool, out JSIsolatePoolStatistics statistics);
+}
+// -------------------------------------------------------------------------
+// Script
+public static class Script
+{
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSScript")]
+public static extern void Retain(JSContext context, JSScript script);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSScript")]
+public static extern void Release(JSContext context, JSScript script);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CompileJSScript")]
+public static extern JSScript Compile(JSContext context, JSString fileName, JSString code, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RunJSScript")]
+public static extern JSValue Run(JSContext context, JSScript script, out JSScriptException error);
+}
+// -------------------------------------------------------------------------
+// NativeClass
+public static class NativeClass
+{
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSClass")]
+public static extern void Retain(JSContext context, JSClass cls);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSClass")]
+public static extern void Release(JSContext context, JSClass cls);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSClass")]
+public static extern JSClass Create(JSContext context, JSString name);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="AddJSClassMethod")]
+public static extern void AddMethod(JSContext context, JSClass cls, JSString name, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSMethodCallback callback, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSClassInstance")]
+public static extern JSObject CreateInstance(JSContext context, JSClass cls, IntPtr instance, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSClassInstance")]
+public static extern IntPtr GetInstance(JSContext context, JSClass cls, JSObject obj, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSClassConstructor")]
+public static extern JSFunction GetConstructor(JSContext context, JSClass cls, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="AddJSClassAccessor")]
+public static extern void AddAccessor(JSContext context, JSClass cls, JSString name, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSGetterCallback getter, [MarshalAs(UnmanagedType.FunctionPtr)]JSSetterCallback setter, out JSRuntimeError error);
+}
+// -------------------------------------------------------------------------
 // Debug
 public static class Debug
 {
@@ -143,21 +418,51 @@ public static extern JSValue CreateDouble(double value);
 public static extern JSValue CreateBool([MarshalAs(UnmanagedType.I1)]bool value);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalJSArrayBuffer")]
 public static extern JSObject CreateExternalArrayBuffer(JSContext context, IntPtr data, int byteLength);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateOwnedJSArrayBuffer")]
+public static extern JSObject CreateOwnedArrayBuffer(JSContext context, IntPtr data, int byteLength, IntPtr owner);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSCallback")]
 public static extern JSFunction CreateCallback(JSContext context, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSCallback callback, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSTypedCallback")]
+public static extern JSFunction CreateTypedCallback(JSContext context, IntPtr data, IntPtr function, [In] ref JSTypedSignature signature, out JSScriptException error);
 // --------------------------------------------------------------------------
 // String
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSString")]
 public static extern JSString CreateString(JSContext context, [MarshalAs(UnmanagedType.LPWStr, SizeParamIndex = 2)]string buffer, int length, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalJSString")]
+public static extern JSString CreateExternalString(JSContext context, IntPtr buffer, int length, IntPtr owner, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalOneByteJSString")]
+public static extern JSString CreateExternalOneByteString(JSContext context, IntPtr buffer, int length, IntPtr owner, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetInternedJSString")]
+public static extern JSString GetInternedString(JSContext context, [MarshalAs(UnmanagedType.LPWStr, SizeParamIndex = 2)]string buffer, int length, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSStringFromUtf8")]
+public static extern JSString CreateStringFromUtf8(JSContext context, byte[] buffer, int byteLength, out JSRuntimeError error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSStringFromOneByte")]
+public static extern JSString CreateStringFromOneByte(JSContext context, byte[] buffer, int length, out JSRuntimeError error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSStringLength")]
 public static extern int Length(JSContext context, JSString str);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="WriteJSStringBuffer")]
 public static extern void Write(JSContext context, JSString str, [Out, MarshalAs(UnmanagedType.LPWStr)]StringBuilder buffer, [MarshalAs(UnmanagedType.I1)]bool nullTerminate);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="WriteJSStringUtf8")]
+public static extern int WriteUtf8(JSContext context, JSString str, [Out]byte[] buffer, int capacity);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="WriteJSStringOneByte")]
+public static extern int WriteOneByte(JSContext context, JSString str, [Out]byte[] buffer, int capacity);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReadJSStringBuffer", CharSet = CharSet.Unicode)]
+public static extern int Read(JSContext context, JSString str, [Out]char[] buffer, int capacity, [MarshalAs(UnmanagedType.I1)]out bool isOneByte);
+[ThreadStatic] static char[] _stringBuffer;
+const int MaxCachedStringBufferLength = 64 * 1024;
 public static string ToString(JSContext context, JSString str)
 {
-	var sb = new StringBuilder(Length(context, str) + 1);
-	Write(context, str, sb, true);
-	return sb.ToString();
+	var buffer = _stringBuffer ?? (_stringBuffer = new char[256]);
+	bool isOneByte;
+	var length = Read(context, str, buffer, buffer.Length, out isOneByte);
+	if (length > buffer.Length)
+	{
+		buffer = new char[length];
+		if (length <= MaxCachedStringBufferLength)
+			_stringBuffer = buffer;
+		Read(context, str, buffer, buffer.Length, out isOneByte);
+	}
+	return new string(buffer, 0, length);
 }
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSStringAsValue")]
 public static extern JSValue AsValue(JSString str);
@@ -167,6 +472,10 @@ public static extern JSValue AsValue(JSString str);
 public static extern JSValue CopyProperty(JSContext context, JSObject obj, JSString key, out JSScriptException error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectProperty")]
 public static extern void SetProperty(JSContext context, JSObject obj, JSString key, JSValue value, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectProperties")]
+public static extern int CopyProperties(JSContext context, JSObject obj, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSString[] keys, int numKeys, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] values, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSScriptException[] errors);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectProperties")]
+public static extern int SetProperties(JSContext context, JSObject obj, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSString[] keys, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValue[] values, int numKeys, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSScriptException[] errors);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectOwnPropertyNames")]
 public static extern JSArray CopyOwnPropertyNames(JSContext context, JSObject obj, out JSScriptException error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSObjectHasProperty")]
@@ -174,6 +483,16 @@ public static extern JSArray CopyOwnPropertyNames(JSContext context, JSObject ob
 public static extern bool HasProperty(JSContext context, JSObject obj, JSString key, out JSScriptException error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSObjectArrayBufferData")]
 public static extern IntPtr GetArrayBufferData(JSContext context, JSObject obj, out JSRuntimeError outError);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSObjectArrayBufferByteLength")]
+public static extern int GetArrayBufferByteLength(JSContext context, JSObject obj, out JSRuntimeError outError);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSArrayBufferView")]
+public static extern JSObject CreateArrayBufferView(JSContext context, JSObject arrayBuffer, JSArrayBufferViewType type, int byteOffset, int length, out JSRuntimeError outError);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalJSArrayBufferView")]
+public static extern JSObject CreateExternalArrayBufferView(JSContext context, JSArrayBufferViewType type, IntPtr data, int length, out JSRuntimeError outError);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSObjectArrayBufferViewData")]
+public static extern IntPtr GetArrayBufferViewData(JSContext context, JSObject obj, out JSArrayBufferViewType type, out int byteOffset, out int byteLength, out JSRuntimeError outError);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectArrayBufferViewBuffer")]
+public static extern JSObject CopyArrayBufferViewBuffer(JSContext context, JSObject obj, out JSRuntimeError outError);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSObjectAsValue")]
 public static extern JSValue AsValue(JSObject obj);
 // -------------------------------------------------------------------------
@@ -182,6 +501,18 @@ public static extern JSValue AsValue(JSObject obj);
 public static extern JSValue CopyProperty(JSContext context, JSArray arr, int index, out JSScriptException error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayPropertyAtIndex")]
 public static extern void SetProperty(JSContext context, JSArray arr, int index, JSValue value, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSArrayRange")]
+public static extern void CopyRange(JSContext context, JSArray arr, int start, int count, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] values, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayRange")]
+public static extern void SetRange(JSContext context, JSArray arr, int start, int count, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] values, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSArrayDoubles")]
+public static extern void CopyDoubles(JSContext context, JSArray arr, int start, int count, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]double[] values, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayDoubles")]
+public static extern void SetDoubles(JSContext context, JSArray arr, int start, int count, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]double[] values, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSArrayInts")]
+public static extern void CopyInts(JSContext context, JSArray arr, int start, int count, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]int[] values, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayInts")]
+public static extern void SetInts(JSContext context, JSArray arr, int start, int count, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]int[] values, out JSScriptException error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSArrayLength")]
 public static extern int Length(JSContext context, JSArray arr);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSArrayAsValue")]
@@ -190,11 +521,33 @@ public static extern JSValue AsValue(JSArray arr);
 // Function
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CallJSFunctionCreate")]
 public static extern JSValue CallCreate(JSContext context, JSFunction function, JSObject thisObject, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValue[] args, int numArgs, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CallJSFunctionBatch")]
+public static extern int CallBatch(JSContext context, JSFunction function, JSObject thisObject, [In]JSValue[] args, int argsPerCall, int numCalls, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 5)]JSValue[] results, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 5)]JSScriptException[] errors);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ConstructJSFunctionCreate")]
 public static extern JSObject ConstructCreate(JSContext context, JSFunction function, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] args, int numArgs, out JSScriptException error);
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSFunctionAsValue")]
 public static extern JSValue AsValue(JSFunction fun);
 // -------------------------------------------------------------------------
+// Unboxed
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CallJSFunctionUnboxed")]
+public static extern void CallUnboxed(JSContext context, JSFunction function, JSObject thisObject, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectPropertyUnboxed")]
+public static extern void CopyPropertyUnboxed(JSContext context, JSObject obj, JSString key, out JSValueUnboxed value, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectPropertyUnboxed")]
+public static extern void SetPropertyUnboxed(JSContext context, JSObject obj, JSString key, [In] ref JSValueUnboxed value, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSUnboxedCallback")]
+public static extern JSFunction CreateUnboxedCallback(JSContext context, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSUnboxedCallback callback, out JSScriptException error);
+[DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectAccessor")]
+public static extern void SetAccessor(JSContext context, JSObject obj, JSString name, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSGetterCallback getter, [MarshalAs(UnmanagedType.FunctionPtr)]JSSetterCallback setter, out JSScriptException error);
+public static void Release(JSContext context, JSValueUnboxed value)
+{
+	switch (value.Type)
+	{
+		case JSType.Null: case JSType.Int: case JSType.Double: case JSType.Bool: break;
+		default: Release(context, value.Handle); break;
+	}
+}
+// -------------------------------------------------------------------------
 // External
 [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSExternal")]
 public static extern JSExternal CreateExternal(JSContext context, IntPtr value);
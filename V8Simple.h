@@ -47,12 +47,32 @@ enum class JSType
 	Function,
 	External,
 };
+/// public enum JSNativeType
+/// {
+/// 	Void,
+/// 	Int,
+/// 	Double,
+/// 	Bool,
+/// }
+enum class JSNativeType
+{
+	Void,
+	Int,
+	Double,
+	Bool,
+};
 /// public enum JSRuntimeError
 /// {
 /// 	NoError,
 /// 	InvalidCast,
 /// 	StringTooLong,
 /// 	TypeError,
+/// 	ScriptError,
+/// 	SnapshotError,
+/// 	RangeError,
+/// 	WrongContext,
+/// 	ShutDown,
+/// 	AlreadyInitialized,
 /// }
 enum class JSRuntimeError
 {
@@ -60,6 +80,164 @@ enum class JSRuntimeError
 	InvalidCast,
 	StringTooLong,
 	TypeError,
+	ScriptError,
+	SnapshotError,
+	RangeError,
+	WrongContext,
+	ShutDown,
+	AlreadyInitialized,
+};
+/// public enum JSArrayBufferViewType
+/// {
+/// 	Int8Array,
+/// 	Uint8Array,
+/// 	Uint8ClampedArray,
+/// 	Int16Array,
+/// 	Uint16Array,
+/// 	Int32Array,
+/// 	Uint32Array,
+/// 	Float32Array,
+/// 	Float64Array,
+/// 	DataView,
+/// }
+enum class JSArrayBufferViewType
+{
+	Int8Array,
+	Uint8Array,
+	Uint8ClampedArray,
+	Int16Array,
+	Uint16Array,
+	Int32Array,
+	Uint32Array,
+	Float32Array,
+	Float64Array,
+	DataView,
+};
+/// public enum JSArrayBufferAllocatorType
+/// {
+/// 	Malloc,
+/// 	Pooled,
+/// }
+enum class JSArrayBufferAllocatorType
+{
+	Malloc,
+	Pooled,
+};
+///// What to do when the used heap grows past HeapLimitPercent of the limit
+///// while script runs. V8 aborts the process when it actually runs out of heap.
+/// public enum JSHeapLimitPolicy
+/// {
+/// 	Default,
+/// 	TerminateExecution,
+/// }
+enum class JSHeapLimitPolicy
+{
+	Default,
+	TerminateExecution,
+};
+///// Zero means V8's default for each of the size fields. StackLimitKB is
+///// counted from where each thread enters the isolate.
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSIsolateOptions
+/// {
+/// 	public int MaxSemiSpaceSizeMB;
+/// 	public int MaxOldSpaceSizeMB;
+/// 	public int CodeRangeSizeMB;
+/// 	public int StackLimitKB;
+/// 	public JSArrayBufferAllocatorType AllocatorType;
+/// 	public JSHeapLimitPolicy HeapLimitPolicy;
+/// 	public int HeapLimitPercent;
+/// }
+struct JSIsolateOptions
+{
+	int MaxSemiSpaceSizeMB;
+	int MaxOldSpaceSizeMB;
+	int CodeRangeSizeMB;
+	int StackLimitKB;
+	JSArrayBufferAllocatorType AllocatorType;
+	JSHeapLimitPolicy HeapLimitPolicy;
+	int HeapLimitPercent;
+};
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSHeapStatistics
+/// {
+/// 	public long TotalHeapSize;
+/// 	public long UsedHeapSize;
+/// 	public long HeapSizeLimit;
+/// 	public long HeapLimitTerminations;
+/// 	public long ExternalMemory;
+/// }
+struct JSHeapStatistics
+{
+	int64_t TotalHeapSize;
+	int64_t UsedHeapSize;
+	int64_t HeapSizeLimit;
+	int64_t HeapLimitTerminations;
+	int64_t ExternalMemory;
+};
+///// Zero WorkerThreads picks a count based on the number of processors.
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSPlatformOptions
+/// {
+/// 	public int WorkerThreads;
+/// }
+struct JSPlatformOptions
+{
+	int WorkerThreads;
+};
+///// The C signature of a typed callback. ArgTypes are Int or Double.
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSTypedSignature
+/// {
+/// 	public const int MaxArgs = 4;
+/// 	public JSNativeType ReturnType;
+/// 	public int NumArgs;
+/// 	[MarshalAs(UnmanagedType.ByValArray, SizeConst = MaxArgs)]
+/// 	public JSNativeType[] ArgTypes;
+/// 	public JSTypedSignature(JSNativeType returnType, params JSNativeType[] argTypes)
+/// 	{
+/// 		ReturnType = returnType;
+/// 		NumArgs = argTypes.Length;
+/// 		ArgTypes = new JSNativeType[MaxArgs];
+/// 		Array.Copy(argTypes, ArgTypes, Math.Min(argTypes.Length, MaxArgs));
+/// 	}
+/// }
+struct JSTypedSignature
+{
+	static const int MaxArgs = 4;
+	JSNativeType ReturnType;
+	int NumArgs;
+	JSNativeType ArgTypes[MaxArgs];
+};
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSArrayBufferAllocatorStatistics
+/// {
+/// 	public long LiveBytes;
+/// 	public long PeakBytes;
+/// 	public long PoolHits;
+/// 	public long PoolMisses;
+/// 	public double PoolHitRate { get { return PoolHits + PoolMisses == 0 ? 0.0 : (double)PoolHits / (PoolHits + PoolMisses); } }
+/// }
+struct JSArrayBufferAllocatorStatistics
+{
+	int64_t LiveBytes;
+	int64_t PeakBytes;
+	int64_t PoolHits;
+	int64_t PoolMisses;
+};
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSIsolatePoolStatistics
+/// {
+/// 	public long Hits;
+/// 	public long Misses;
+/// 	public long Idle;
+/// 	public double HitRate { get { return Hits + Misses == 0 ? 0.0 : (double)Hits / (Hits + Misses); } }
+/// }
+struct JSIsolatePoolStatistics
+{
+	int64_t Hits;
+	int64_t Misses;
+	int64_t Idle;
 };
 /// [StructLayout(LayoutKind.Sequential)]
 /// public struct JSContext
@@ -113,15 +291,120 @@ struct JSExternal;
 /// 	public static bool operator !=(JSScriptException e1, JSScriptException e2) { return e1._handle != e2._handle; }
 /// }
 struct JSScriptException;
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSCodeCache
+/// {
+/// 	readonly IntPtr _handle;
+/// }
+struct JSCodeCache;
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSScript
+/// {
+/// 	readonly IntPtr _handle;
+/// }
+struct JSScript;
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSSnapshot
+/// {
+/// 	readonly IntPtr _handle;
+/// }
+struct JSSnapshot;
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSIsolatePool
+/// {
+/// 	readonly IntPtr _handle;
+/// }
+struct JSIsolatePool;
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSIsolate
+/// {
+/// 	readonly IntPtr _handle;
+/// }
+struct JSIsolate;
+/// [StructLayout(LayoutKind.Sequential)]
+/// public struct JSClass
+/// {
+/// 	readonly IntPtr _handle;
+/// }
+struct JSClass;
+///// A value that carries ints, doubles and bools inline instead of through
+///// a refcounted JSValue. For other types Handle holds the JSValue.
+/// [StructLayout(LayoutKind.Explicit, Size = 16)]
+/// public struct JSValueUnboxed
+/// {
+/// 	[FieldOffset(0)] public JSType Type;
+/// 	[FieldOffset(8)] public int Int;
+/// 	[FieldOffset(8)] public double Double;
+/// 	[FieldOffset(8)] byte _bool;
+/// 	[FieldOffset(8)] public JSValue Handle;
+/// 	public bool Bool { get { return _bool != 0; } set { _bool = value ? (byte)1 : (byte)0; } }
+/// 	public static JSValueUnboxed FromInt(int value) { var result = new JSValueUnboxed(); result.Type = JSType.Int; result.Int = value; return result; }
+/// 	public static JSValueUnboxed FromDouble(double value) { var result = new JSValueUnboxed(); result.Type = JSType.Double; result.Double = value; return result; }
+/// 	public static JSValueUnboxed FromBool(bool value) { var result = new JSValueUnboxed(); result.Type = JSType.Bool; result.Bool = value; return result; }
+/// 	public static JSValueUnboxed FromValue(JSValue value) { var result = new JSValueUnboxed(); result.Type = Value.GetType(value); result.Handle = value; return result; }
+/// }
+struct JSValueUnboxed
+{
+	JSType Type;
+	union
+	{
+		int Int;
+		double Double;
+		bool Bool;
+		JSValue* Handle;
+	};
+};
 /// public delegate JSValue JSCallback(JSContext context, IntPtr data, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] args, int numArgs, out JSValue error);
 typedef JSValue* (StdCall *JSCallback)(JSContext* context, void* data, JSValue* const* args, int numArgs, JSValue** outError);
 /// public delegate void JSExternalFinalizer(IntPtr external);
 typedef void (StdCall *JSExternalFinalizer)(void* external);
 /// public delegate void JSCallbackFinalizer(IntPtr data);
 typedef void (StdCall *JSCallbackFinalizer)(void* data);
+///// Handles in args are only valid during the call. Handles returned in result
+///// and error are released by the caller.
+/// public delegate void JSUnboxedCallback(JSContext context, IntPtr data, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error);
+typedef void (StdCall *JSUnboxedCallback)(JSContext* context, void* data, const JSValueUnboxed* args, int numArgs, JSValueUnboxed* outResult, JSValueUnboxed* outError);
+///// A prototype method of a native class. instance is the pointer that the
+///// receiver was created with.
+/// public delegate void JSMethodCallback(JSContext context, IntPtr data, IntPtr instance, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error);
+typedef void (StdCall *JSMethodCallback)(JSContext* context, void* data, void* instance, const JSValueUnboxed* args, int numArgs, JSValueUnboxed* outResult, JSValueUnboxed* outError);
+///// Native property accessors. instance is null for accessors on plain
+///// objects. Handles in value are only valid during the call.
+/// public delegate void JSGetterCallback(JSContext context, IntPtr data, IntPtr instance, out JSValueUnboxed result, out JSValueUnboxed error);
+typedef void (StdCall *JSGetterCallback)(JSContext* context, void* data, void* instance, JSValueUnboxed* outResult, JSValueUnboxed* outError);
+/// public delegate void JSSetterCallback(JSContext context, IntPtr data, IntPtr instance, [In] ref JSValueUnboxed value, out JSValueUnboxed error);
+typedef void (StdCall *JSSetterCallback)(JSContext* context, void* data, void* instance, const JSValueUnboxed* value, JSValueUnboxed* outError);
+///// Cast to the signature given to CreateTypedCallback before calling
+typedef void (StdCall *JSTypedFunction)();
 /// public delegate void JSDebugMessageHandler(IntPtr data, JSString message);
 typedef void (StdCall *JSDebugMessageHandler)(void* data, JSString* message);
 
+/// // -------------------------------------------------------------------------
+/// // Platform
+/// public static class Platform
+/// {
+///// Initializes V8 with options. Creating the first context or isolate does
+///// this with default options otherwise. Fails with AlreadyInitialized when
+///// V8 is already running, ignoring options, and with ShutDown after
+///// Shutdown. Safe to call from several threads.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="InitializeV8Simple")]
+/// public static extern void Initialize([In] ref JSPlatformOptions options, out JSRuntimeError error);
+DllPublic void CDecl InitializeV8Simple(const JSPlatformOptions* options, JSRuntimeError* outError);
+///// The options V8 is running with. Returns false while V8 is not running.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetV8SimplePlatformOptions")]
+/// [return: MarshalAs(UnmanagedType.I1)]
+/// public static extern bool GetOptions(out JSPlatformOptions options);
+DllPublic bool CDecl GetV8SimplePlatformOptions(JSPlatformOptions* outOptions);
+///// Disposes V8 and its platform. Returns false, doing nothing, while any
+///// context or isolate is alive. V8 cannot be initialized again afterwards,
+///// so creating contexts, isolates and snapshots then fails with ShutDown,
+///// or returns null where there is no error parameter.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ShutdownV8Simple")]
+/// [return: MarshalAs(UnmanagedType.I1)]
+/// public static extern bool Shutdown();
+DllPublic bool CDecl ShutdownV8Simple();
+/// }
+
 /// // -------------------------------------------------------------------------
 /// // Context
 /// public static class Context
@@ -135,9 +418,52 @@ DllPublic void CDecl ReleaseJSContext(JSContext* context);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContext")]
 /// public static extern JSContext Create([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer);
 DllPublic JSContext* CDecl CreateJSContext(JSCallbackFinalizer callbackFinalizer, JSExternalFinalizer externalFinalizer);
+///// Creates a context by deserializing a startup snapshot made by
+///// Snapshot.Create. Fails with SnapshotError if the snapshot was made by a
+///// different V8 version.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextFromSnapshot")]
+/// public static extern JSContext CreateFromSnapshot([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]byte[] snapshot, int snapshotLength, out JSRuntimeError error);
+DllPublic JSContext* CDecl CreateJSContextFromSnapshot(JSCallbackFinalizer callbackFinalizer, JSExternalFinalizer externalFinalizer, const uint8_t* snapshot, int snapshotLength, JSRuntimeError* outError);
+///// The Pooled allocator recycles freed small ArrayBuffer backing stores
+///// instead of returning them to the system allocator
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextWithArrayBufferAllocator")]
+/// public static extern JSContext CreateWithArrayBufferAllocator([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer, JSArrayBufferAllocatorType allocatorType);
+DllPublic JSContext* CDecl CreateJSContextWithArrayBufferAllocator(JSCallbackFinalizer callbackFinalizer, JSExternalFinalizer externalFinalizer, JSArrayBufferAllocatorType allocatorType);
+///// Creates a context in a new isolate configured by options. Fails with
+///// RangeError if a size or HeapLimitPercent is out of range.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextWithOptions")]
+/// public static extern JSContext CreateWithOptions([MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer, [In] ref JSIsolateOptions options, out JSRuntimeError error);
+DllPublic JSContext* CDecl CreateJSContextWithOptions(JSCallbackFinalizer callbackFinalizer, JSExternalFinalizer externalFinalizer, const JSIsolateOptions* options, JSRuntimeError* outError);
+///// The isolate the context lives in. Not retained.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSContextIsolate")]
+/// public static extern JSIsolate GetIsolate(JSContext context);
+DllPublic JSIsolate* CDecl GetJSContextIsolate(JSContext* context);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSContextArrayBufferAllocatorStatistics")]
+/// public static extern void GetArrayBufferAllocatorStatistics(JSContext context, out JSArrayBufferAllocatorStatistics statistics);
+DllPublic void CDecl GetJSContextArrayBufferAllocatorStatistics(JSContext* context, JSArrayBufferAllocatorStatistics* outStatistics);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSContextEvaluateCreate")]
 /// public static extern JSValue EvaluateCreate(JSContext context, JSString fileName, JSString code, out JSScriptException error);
 DllPublic JSValue* CDecl JSContextEvaluateCreate(JSContext* context, JSString* fileName, JSString* code, JSScriptException** outError);
+///// Like EvaluateCreate, but consumes a code cache produced by an earlier
+///// call when one is given. When no cache is given, or V8 refused the given
+///// one, a new cache is produced and returned in outCache. outCacheRejected
+///// is set when V8 refused the given cache, e.g. because it was produced by
+///// a different V8 version or for different code.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSContextEvaluateCachedCreate")]
+/// public static extern JSValue EvaluateCachedCreate(JSContext context, JSString fileName, JSString code, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]byte[] cache, int cacheLength, out JSCodeCache outCache, [MarshalAs(UnmanagedType.I1)]out bool outCacheRejected, out JSScriptException error);
+DllPublic JSValue* CDecl JSContextEvaluateCachedCreate(JSContext* context, JSString* fileName, JSString* code, const uint8_t* cache, int cacheLength, JSCodeCache** outCache, bool* outCacheRejected, JSScriptException** outError);
+///// Locks and enters the context on the calling thread until the matching
+///// ExitScope, so that calls in between skip taking the lock and entering
+///// the context. Scopes nest and must be exited in reverse order on the
+///// same thread. Other threads are locked out while a scope is entered.
+///// ExitScope fails with WrongContext, leaving the scopes as they are, when
+///// context is not the innermost one entered on this thread.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="EnterJSContextScope")]
+/// public static extern void EnterScope(JSContext context);
+DllPublic void CDecl EnterJSContextScope(JSContext* context);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ExitJSContextScope")]
+/// public static extern void ExitScope(JSContext context, out JSRuntimeError error);
+DllPublic void CDecl ExitJSContextScope(JSContext* context, JSRuntimeError* outError);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSContextCopyGlobalObject")]
 /// public static extern JSObject CopyGlobalObject(JSContext context);
 DllPublic JSObject* CDecl JSContextCopyGlobalObject(JSContext* context);
@@ -147,6 +473,177 @@ DllPublic JSObject* CDecl JSContextCopyGlobalObject(JSContext* context);
 DllPublic const char* CDecl GetV8Version();
 /// }
 
+/// // -------------------------------------------------------------------------
+/// // Code cache
+/// public static class CodeCache
+/// {
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSCodeCache")]
+/// public static extern void Release(JSCodeCache cache);
+DllPublic void CDecl ReleaseJSCodeCache(JSCodeCache* cache);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSCodeCacheData")]
+/// public static extern IntPtr GetData(JSCodeCache cache);
+DllPublic const uint8_t* CDecl GetJSCodeCacheData(JSCodeCache* cache);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSCodeCacheLength")]
+/// public static extern int GetLength(JSCodeCache cache);
+DllPublic int CDecl GetJSCodeCacheLength(JSCodeCache* cache);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSCodeCacheVersionTag")]
+/// public static extern uint GetVersionTag();
+DllPublic uint32_t CDecl GetJSCodeCacheVersionTag();
+/// public static byte[] ToArray(JSCodeCache cache)
+/// {
+/// 	var result = new byte[GetLength(cache)];
+/// 	Marshal.Copy(GetData(cache), result, 0, result.Length);
+/// 	return result;
+/// }
+/// }
+
+/// // -------------------------------------------------------------------------
+/// // Snapshot
+/// public static class Snapshot
+/// {
+///// Runs code in a fresh context and serializes the resulting heap into a
+///// startup snapshot. Fails with ScriptError if the code throws.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSSnapshot")]
+/// public static extern JSSnapshot Create([MarshalAs(UnmanagedType.LPWStr, SizeParamIndex = 1)]string code, int codeLength, out JSRuntimeError error);
+DllPublic JSSnapshot* CDecl CreateJSSnapshot(const uint16_t* code, int codeLength, JSRuntimeError* outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSSnapshot")]
+/// public static extern void Release(JSSnapshot snapshot);
+DllPublic void CDecl ReleaseJSSnapshot(JSSnapshot* snapshot);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSSnapshotData")]
+/// public static extern IntPtr GetData(JSSnapshot snapshot);
+DllPublic const uint8_t* CDecl GetJSSnapshotData(JSSnapshot* snapshot);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSSnapshotLength")]
+/// public static extern int GetLength(JSSnapshot snapshot);
+DllPublic int CDecl GetJSSnapshotLength(JSSnapshot* snapshot);
+/// public static byte[] ToArray(JSSnapshot snapshot)
+/// {
+/// 	var result = new byte[GetLength(snapshot)];
+/// 	Marshal.Copy(GetData(snapshot), result, 0, result.Length);
+/// 	return result;
+/// }
+/// }
+
+/// // -------------------------------------------------------------------------
+/// // Isolate
+/// public static class Isolate
+/// {
+///// Creates an isolate, a heap that several contexts can share along with
+///// compiled code and the string table. Values and scripts can be used
+///// with any context in the isolate they were created in. The snapshot is
+///// optional (see Snapshot.Create).
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSIsolate")]
+/// public static extern JSIsolate Create([In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 1)]byte[] snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, out JSRuntimeError error);
+DllPublic JSIsolate* CDecl CreateJSIsolate(const uint8_t* snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, JSRuntimeError* outError);
+///// Like Create, but configured by options
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSIsolateWithOptions")]
+/// public static extern JSIsolate CreateWithOptions([In] ref JSIsolateOptions options, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 2)]byte[] snapshot, int snapshotLength, out JSRuntimeError error);
+DllPublic JSIsolate* CDecl CreateJSIsolateWithOptions(const JSIsolateOptions* options, const uint8_t* snapshot, int snapshotLength, JSRuntimeError* outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSIsolateHeapStatistics")]
+/// public static extern void GetHeapStatistics(JSIsolate isolate, out JSHeapStatistics statistics);
+DllPublic void CDecl GetJSIsolateHeapStatistics(JSIsolate* isolate, JSHeapStatistics* outStatistics);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSIsolate")]
+/// public static extern void Retain(JSIsolate isolate);
+DllPublic void CDecl RetainJSIsolate(JSIsolate* isolate);
+///// Contexts created in the isolate keep it alive
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSIsolate")]
+/// public static extern void Release(JSIsolate isolate);
+DllPublic void CDecl ReleaseJSIsolate(JSIsolate* isolate);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextInIsolate")]
+/// public static extern JSContext CreateContext(JSIsolate isolate, [MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer);
+DllPublic JSContext* CDecl CreateJSContextInIsolate(JSIsolate* isolate, JSCallbackFinalizer callbackFinalizer, JSExternalFinalizer externalFinalizer);
+/// }
+
+/// // -------------------------------------------------------------------------
+/// // IsolatePool
+/// public static class IsolatePool
+/// {
+///// Creates size isolates up front, each starting from snapshot if one is
+///// given (see Snapshot.Create). Contexts created from the pool take an idle
+///// isolate, or create a new one if there is none. When such a context is
+///// released, its isolate is garbage collected and kept for the next
+///// context, as long as there are fewer than size idle isolates.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSIsolatePool")]
+/// public static extern JSIsolatePool Create(int size, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 2)]byte[] snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, out JSRuntimeError error);
+DllPublic JSIsolatePool* CDecl CreateJSIsolatePool(int size, const uint8_t* snapshot, int snapshotLength, JSArrayBufferAllocatorType allocatorType, JSRuntimeError* outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSIsolatePool")]
+/// public static extern void Retain(JSIsolatePool pool);
+DllPublic void CDecl RetainJSIsolatePool(JSIsolatePool* pool);
+///// Contexts created from the pool keep it alive
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSIsolatePool")]
+/// public static extern void Release(JSIsolatePool pool);
+DllPublic void CDecl ReleaseJSIsolatePool(JSIsolatePool* pool);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSContextFromIsolatePool")]
+/// public static extern JSContext CreateContext(JSIsolatePool pool, [MarshalAs(UnmanagedType.FunctionPtr)]JSCallbackFinalizer callbackFinalizer, [MarshalAs(UnmanagedType.FunctionPtr)]JSExternalFinalizer externalFinalizer);
+DllPublic JSContext* CDecl CreateJSContextFromIsolatePool(JSIsolatePool* pool, JSCallbackFinalizer callbackFinalizer, JSExternalFinalizer externalFinalizer);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSIsolatePoolStatistics")]
+/// public static extern void GetStatistics(JSIsolatePool pool, out JSIsolatePoolStatistics statistics);
+DllPublic void CDecl GetJSIsolatePoolStatistics(JSIsolatePool* pool, JSIsolatePoolStatistics* outStatistics);
+/// }
+
+/// // -------------------------------------------------------------------------
+/// // Script
+/// public static class Script
+/// {
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSScript")]
+/// public static extern void Retain(JSContext context, JSScript script);
+DllPublic void CDecl RetainJSScript(JSContext* context, JSScript* script);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSScript")]
+/// public static extern void Release(JSContext context, JSScript script);
+DllPublic void CDecl ReleaseJSScript(JSContext* context, JSScript* script);
+///// The compiled script is not bound to a context and can be run in any
+///// context of the isolate it was compiled in
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CompileJSScript")]
+/// public static extern JSScript Compile(JSContext context, JSString fileName, JSString code, out JSScriptException error);
+DllPublic JSScript* CDecl CompileJSScript(JSContext* context, JSString* fileName, JSString* code, JSScriptException** outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RunJSScript")]
+/// public static extern JSValue Run(JSContext context, JSScript script, out JSScriptException error);
+DllPublic JSValue* CDecl RunJSScript(JSContext* context, JSScript* script, JSScriptException** outError);
+/// }
+
+/// // -------------------------------------------------------------------------
+/// // NativeClass
+///// Native classes are built on a FunctionTemplate. Their instances share
+///// one hidden class and hold a native pointer in an internal field. A class
+///// belongs to the context it was created in. Using it with another context
+///// fails with WrongContext, or a TypeError for the calls that report script
+///// exceptions. Methods are passed the class's context, and throw an Error
+///// when called after it is released.
+/// public static class NativeClass
+/// {
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="RetainJSClass")]
+/// public static extern void Retain(JSContext context, JSClass cls);
+DllPublic void CDecl RetainJSClass(JSContext* context, JSClass* cls);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReleaseJSClass")]
+/// public static extern void Release(JSContext context, JSClass cls);
+DllPublic void CDecl ReleaseJSClass(JSContext* context, JSClass* cls);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSClass")]
+/// public static extern JSClass Create(JSContext context, JSString name);
+DllPublic JSClass* CDecl CreateJSClass(JSContext* context, JSString* name);
+///// Fails with TypeError once the class has instances or a constructor
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="AddJSClassMethod")]
+/// public static extern void AddMethod(JSContext context, JSClass cls, JSString name, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSMethodCallback callback, out JSRuntimeError error);
+DllPublic void CDecl AddJSClassMethod(JSContext* context, JSClass* cls, JSString* name, void* data, JSMethodCallback callback, JSRuntimeError* outError);
+///// instance must be 2-byte aligned. The context's external finalizer is
+///// called with it once the object is garbage collected.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSClassInstance")]
+/// public static extern JSObject CreateInstance(JSContext context, JSClass cls, IntPtr instance, out JSScriptException error);
+DllPublic JSObject* CDecl CreateJSClassInstance(JSContext* context, JSClass* cls, void* instance, JSScriptException** outError);
+///// Fails with InvalidCast if obj is not an instance of cls
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSClassInstance")]
+/// public static extern IntPtr GetInstance(JSContext context, JSClass cls, JSObject obj, out JSRuntimeError error);
+DllPublic void* CDecl GetJSClassInstance(JSContext* context, JSClass* cls, JSObject* obj, JSRuntimeError* outError);
+///// For instanceof checks. Objects constructed with it from JS have a null
+///// instance pointer.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSClassConstructor")]
+/// public static extern JSFunction GetConstructor(JSContext context, JSClass cls, out JSScriptException error);
+DllPublic JSFunction* CDecl GetJSClassConstructor(JSContext* context, JSClass* cls, JSScriptException** outError);
+///// Installs a native accessor on every instance. A null setter makes the
+///// property read-only. Fails with TypeError like AddMethod.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="AddJSClassAccessor")]
+/// public static extern void AddAccessor(JSContext context, JSClass cls, JSString name, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSGetterCallback getter, [MarshalAs(UnmanagedType.FunctionPtr)]JSSetterCallback setter, out JSRuntimeError error);
+DllPublic void CDecl AddJSClassAccessor(JSContext* context, JSClass* cls, JSString* name, void* data, JSGetterCallback getter, JSSetterCallback setter, JSRuntimeError* outError);
+/// }
+
 /// // -------------------------------------------------------------------------
 /// // Debug
 /// public static class Debug
@@ -223,26 +720,93 @@ DllPublic JSValue* CDecl CreateJSBool(bool value);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalJSArrayBuffer")]
 /// public static extern JSObject CreateExternalArrayBuffer(JSContext context, IntPtr data, int byteLength);
 DllPublic JSObject* CDecl CreateExternalJSArrayBuffer(JSContext* context, void* data, int byteLength);
+///// The context's external finalizer is called with owner when the buffer is
+///// garbage collected. byteLength is reported to V8 as externally allocated
+///// memory while the buffer is alive.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateOwnedJSArrayBuffer")]
+/// public static extern JSObject CreateOwnedArrayBuffer(JSContext context, IntPtr data, int byteLength, IntPtr owner);
+DllPublic JSObject* CDecl CreateOwnedJSArrayBuffer(JSContext* context, void* data, int byteLength, void* owner);
+///// The callback is passed the context the function was created in. Calling
+///// the function after that context is released throws an Error instead.
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSCallback")]
 /// public static extern JSFunction CreateCallback(JSContext context, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSCallback callback, out JSScriptException error);
 DllPublic JSFunction* CDecl CreateJSCallback(JSContext* context, void* data, JSCallback callback, JSScriptException** outError);
+///// function is called as `ReturnType function(IntPtr data, ArgTypes...)` with
+///// the arguments converted like JS does for numbers. An unsupported
+///// signature is reported as a TypeError in error.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSTypedCallback")]
+/// public static extern JSFunction CreateTypedCallback(JSContext context, IntPtr data, IntPtr function, [In] ref JSTypedSignature signature, out JSScriptException error);
+DllPublic JSFunction* CDecl CreateJSTypedCallback(JSContext* context, void* data, JSTypedFunction function, const JSTypedSignature* signature, JSScriptException** outError);
 
 /// // --------------------------------------------------------------------------
 /// // String
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSString")]
 /// public static extern JSString CreateString(JSContext context, [MarshalAs(UnmanagedType.LPWStr, SizeParamIndex = 2)]string buffer, int length, out JSRuntimeError error);
 DllPublic JSString* CDecl CreateJSString(JSContext* context, const uint16_t* buffer, int length, JSRuntimeError* outError);
+///// Creates a string that refers to buffer without copying it. The buffer
+///// must stay alive and unchanged until the context's external finalizer is
+///// called with owner. On error the finalizer is not called.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalJSString")]
+/// public static extern JSString CreateExternalString(JSContext context, IntPtr buffer, int length, IntPtr owner, out JSRuntimeError error);
+DllPublic JSString* CDecl CreateExternalJSString(JSContext* context, const uint16_t* buffer, int length, void* owner, JSRuntimeError* outError);
+///// Like CreateExternalString, but for Latin-1 buffers
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalOneByteJSString")]
+/// public static extern JSString CreateExternalOneByteString(JSContext context, IntPtr buffer, int length, IntPtr owner, out JSRuntimeError error);
+DllPublic JSString* CDecl CreateExternalOneByteJSString(JSContext* context, const char* buffer, int length, void* owner, JSRuntimeError* outError);
+///// Returns an internalized string owned by the context, the same one for
+///// every call with the same contents. Meant for property name keys; it
+///// stays valid until the context is released and must not be released.
+///// A length of -1 means buffer is null-terminated; other negative lengths
+///// fail with RangeError.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetInternedJSString")]
+/// public static extern JSString GetInternedString(JSContext context, [MarshalAs(UnmanagedType.LPWStr, SizeParamIndex = 2)]string buffer, int length, out JSRuntimeError error);
+DllPublic JSString* CDecl GetInternedJSString(JSContext* context, const uint16_t* buffer, int length, JSRuntimeError* outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSStringFromUtf8")]
+/// public static extern JSString CreateStringFromUtf8(JSContext context, byte[] buffer, int byteLength, out JSRuntimeError error);
+DllPublic JSString* CDecl CreateJSStringFromUtf8(JSContext* context, const char* buffer, int byteLength, JSRuntimeError* outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSStringFromOneByte")]
+/// public static extern JSString CreateStringFromOneByte(JSContext context, byte[] buffer, int length, out JSRuntimeError error);
+DllPublic JSString* CDecl CreateJSStringFromOneByte(JSContext* context, const uint8_t* buffer, int length, JSRuntimeError* outError);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSStringLength")]
 /// public static extern int Length(JSContext context, JSString str);
 DllPublic int CDecl JSStringLength(JSContext* context, JSString* string);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="WriteJSStringBuffer")]
 /// public static extern void Write(JSContext context, JSString str, [Out, MarshalAs(UnmanagedType.LPWStr)]StringBuilder buffer, [MarshalAs(UnmanagedType.I1)]bool nullTerminate);
 DllPublic void CDecl WriteJSStringBuffer(JSContext* context, JSString* string, uint16_t* outBuffer, bool nullTerminate);
+///// Writes at most capacity bytes of UTF-8, never splitting a character, and
+///// returns the UTF-8 length of the whole string. If that is larger than
+///// capacity the output was truncated. No null terminator is written.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="WriteJSStringUtf8")]
+/// public static extern int WriteUtf8(JSContext context, JSString str, [Out]byte[] buffer, int capacity);
+DllPublic int CDecl WriteJSStringUtf8(JSContext* context, JSString* string, char* outBuffer, int capacity);
+///// Writes at most capacity Latin-1 characters and returns the length of the
+///// whole string. Characters above U+00FF are truncated to their low byte.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="WriteJSStringOneByte")]
+/// public static extern int WriteOneByte(JSContext context, JSString str, [Out]byte[] buffer, int capacity);
+DllPublic int CDecl WriteJSStringOneByte(JSContext* context, JSString* string, uint8_t* outBuffer, int capacity);
+///// Copies at most capacity UTF-16 code units and returns the length of the
+///// whole string, so a caller only needs to retry with a larger buffer when
+///// the result is larger than capacity. outIsOneByte tells whether V8
+///// stores the string as Latin-1. No null terminator is written, and nothing
+///// at all when capacity is zero or negative.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ReadJSStringBuffer", CharSet = CharSet.Unicode)]
+/// public static extern int Read(JSContext context, JSString str, [Out]char[] buffer, int capacity, [MarshalAs(UnmanagedType.I1)]out bool isOneByte);
+DllPublic int CDecl ReadJSStringBuffer(JSContext* context, JSString* string, uint16_t* outBuffer, int capacity, bool* outIsOneByte);
+/// [ThreadStatic] static char[] _stringBuffer;
+/// const int MaxCachedStringBufferLength = 64 * 1024;
 /// public static string ToString(JSContext context, JSString str)
 /// {
-/// 	var sb = new StringBuilder(Length(context, str) + 1);
-/// 	Write(context, str, sb, true);
-/// 	return sb.ToString();
+/// 	var buffer = _stringBuffer ?? (_stringBuffer = new char[256]);
+/// 	bool isOneByte;
+/// 	var length = Read(context, str, buffer, buffer.Length, out isOneByte);
+/// 	if (length > buffer.Length)
+/// 	{
+/// 		buffer = new char[length];
+/// 		if (length <= MaxCachedStringBufferLength)
+/// 			_stringBuffer = buffer;
+/// 		Read(context, str, buffer, buffer.Length, out isOneByte);
+/// 	}
+/// 	return new string(buffer, 0, length);
 /// }
 
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSStringAsValue")]
@@ -257,6 +821,14 @@ DllPublic JSValue* CDecl CopyJSObjectProperty(JSContext* context, JSObject* obj,
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectProperty")]
 /// public static extern void SetProperty(JSContext context, JSObject obj, JSString key, JSValue value, out JSScriptException error);
 DllPublic void CDecl SetJSObjectProperty(JSContext* context, JSObject* obj, JSString* key, JSValue* value, JSScriptException** outError);
+///// Batch versions of CopyProperty and SetProperty. The errors array gets
+///// one entry per key, and the number of failed keys is returned.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectProperties")]
+/// public static extern int CopyProperties(JSContext context, JSObject obj, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSString[] keys, int numKeys, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] values, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSScriptException[] errors);
+DllPublic int CDecl CopyJSObjectProperties(JSContext* context, JSObject* obj, JSString* const* keys, int numKeys, JSValue** outValues, JSScriptException** outErrors);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectProperties")]
+/// public static extern int SetProperties(JSContext context, JSObject obj, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSString[] keys, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValue[] values, int numKeys, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSScriptException[] errors);
+DllPublic int CDecl SetJSObjectProperties(JSContext* context, JSObject* obj, JSString* const* keys, JSValue* const* values, int numKeys, JSScriptException** outErrors);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectOwnPropertyNames")]
 /// public static extern JSArray CopyOwnPropertyNames(JSContext context, JSObject obj, out JSScriptException error);
 DllPublic JSArray* CDecl CopyJSObjectOwnPropertyNames(JSContext* context, JSObject* obj, JSScriptException** outError);
@@ -267,6 +839,26 @@ DllPublic bool CDecl JSObjectHasProperty(JSContext* context, JSObject* obj, JSSt
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSObjectArrayBufferData")]
 /// public static extern IntPtr GetArrayBufferData(JSContext context, JSObject obj, out JSRuntimeError outError);
 DllPublic void* CDecl GetJSObjectArrayBufferData(JSContext* context, JSObject* obj, JSRuntimeError* outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSObjectArrayBufferByteLength")]
+/// public static extern int GetArrayBufferByteLength(JSContext context, JSObject obj, out JSRuntimeError outError);
+DllPublic int CDecl GetJSObjectArrayBufferByteLength(JSContext* context, JSObject* obj, JSRuntimeError* outError);
+///// Creates a typed array or DataView of length elements over arrayBuffer.
+///// byteOffset must be a multiple of the element size.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSArrayBufferView")]
+/// public static extern JSObject CreateArrayBufferView(JSContext context, JSObject arrayBuffer, JSArrayBufferViewType type, int byteOffset, int length, out JSRuntimeError outError);
+DllPublic JSObject* CDecl CreateJSArrayBufferView(JSContext* context, JSObject* arrayBuffer, JSArrayBufferViewType type, int byteOffset, int length, JSRuntimeError* outError);
+///// Not memory managed; add an External property if data needs to be retained
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateExternalJSArrayBufferView")]
+/// public static extern JSObject CreateExternalArrayBufferView(JSContext context, JSArrayBufferViewType type, IntPtr data, int length, out JSRuntimeError outError);
+DllPublic JSObject* CDecl CreateExternalJSArrayBufferView(JSContext* context, JSArrayBufferViewType type, void* data, int length, JSRuntimeError* outError);
+///// Returns a pointer to the first byte of the view, i.e. the buffer data
+///// plus byteOffset
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="GetJSObjectArrayBufferViewData")]
+/// public static extern IntPtr GetArrayBufferViewData(JSContext context, JSObject obj, out JSArrayBufferViewType type, out int byteOffset, out int byteLength, out JSRuntimeError outError);
+DllPublic void* CDecl GetJSObjectArrayBufferViewData(JSContext* context, JSObject* obj, JSArrayBufferViewType* outType, int* outByteOffset, int* outByteLength, JSRuntimeError* outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectArrayBufferViewBuffer")]
+/// public static extern JSObject CopyArrayBufferViewBuffer(JSContext context, JSObject obj, out JSRuntimeError outError);
+DllPublic JSObject* CDecl CopyJSObjectArrayBufferViewBuffer(JSContext* context, JSObject* obj, JSRuntimeError* outError);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSObjectAsValue")]
 /// public static extern JSValue AsValue(JSObject obj);
 DllPublic JSValue* CDecl JSObjectAsValue(JSObject* obj);
@@ -279,6 +871,27 @@ DllPublic JSValue* CDecl CopyJSArrayPropertyAtIndex(JSContext* context, JSArray*
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayPropertyAtIndex")]
 /// public static extern void SetProperty(JSContext context, JSArray arr, int index, JSValue value, out JSScriptException error);
 DllPublic void CDecl SetJSArrayPropertyAtIndex(JSContext* context, JSArray* arr, int index, JSValue* value, JSScriptException** outError);
+///// Copies or sets the elements in [start, start + count). If an error
+///// occurs, no values are returned from CopyRange.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSArrayRange")]
+/// public static extern void CopyRange(JSContext context, JSArray arr, int start, int count, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] values, out JSScriptException error);
+DllPublic void CDecl CopyJSArrayRange(JSContext* context, JSArray* arr, int start, int count, JSValue** outValues, JSScriptException** outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayRange")]
+/// public static extern void SetRange(JSContext context, JSArray arr, int start, int count, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] values, out JSScriptException error);
+DllPublic void CDecl SetJSArrayRange(JSContext* context, JSArray* arr, int start, int count, JSValue* const* values, JSScriptException** outError);
+///// Elements are converted as by the JS Number and ToInt32 conversions
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSArrayDoubles")]
+/// public static extern void CopyDoubles(JSContext context, JSArray arr, int start, int count, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]double[] values, out JSScriptException error);
+DllPublic void CDecl CopyJSArrayDoubles(JSContext* context, JSArray* arr, int start, int count, double* outValues, JSScriptException** outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayDoubles")]
+/// public static extern void SetDoubles(JSContext context, JSArray arr, int start, int count, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]double[] values, out JSScriptException error);
+DllPublic void CDecl SetJSArrayDoubles(JSContext* context, JSArray* arr, int start, int count, const double* values, JSScriptException** outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSArrayInts")]
+/// public static extern void CopyInts(JSContext context, JSArray arr, int start, int count, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]int[] values, out JSScriptException error);
+DllPublic void CDecl CopyJSArrayInts(JSContext* context, JSArray* arr, int start, int count, int32_t* outValues, JSScriptException** outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSArrayInts")]
+/// public static extern void SetInts(JSContext context, JSArray arr, int start, int count, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]int[] values, out JSScriptException error);
+DllPublic void CDecl SetJSArrayInts(JSContext* context, JSArray* arr, int start, int count, const int32_t* values, JSScriptException** outError);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="JSArrayLength")]
 /// public static extern int Length(JSContext context, JSArray arr);
 DllPublic int CDecl JSArrayLength(JSContext* context, JSArray* arr);
@@ -291,6 +904,14 @@ DllPublic JSValue* CDecl JSArrayAsValue(JSArray* arr);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CallJSFunctionCreate")]
 /// public static extern JSValue CallCreate(JSContext context, JSFunction function, JSObject thisObject, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValue[] args, int numArgs, out JSScriptException error);
 DllPublic JSValue* CDecl CallJSFunctionCreate(JSContext* context, JSFunction* function, JSObject* thisObject, JSValue* const* args, int numArgs, JSScriptException** outError);
+///// Calls function numCalls times in one scope. args holds argsPerCall
+///// arguments for each call, one call after another. The results and errors
+///// arrays get one entry per call, and the number of failed calls is returned.
+///// Returns -1 without calling or touching the arrays when argsPerCall or
+///// numCalls is negative.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CallJSFunctionBatch")]
+/// public static extern int CallBatch(JSContext context, JSFunction function, JSObject thisObject, [In]JSValue[] args, int argsPerCall, int numCalls, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 5)]JSValue[] results, [Out, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 5)]JSScriptException[] errors);
+DllPublic int CDecl CallJSFunctionBatch(JSContext* context, JSFunction* function, JSObject* thisObject, JSValue* const* args, int argsPerCall, int numCalls, JSValue** outResults, JSScriptException** outErrors);
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="ConstructJSFunctionCreate")]
 /// public static extern JSObject ConstructCreate(JSContext context, JSFunction function, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)]JSValue[] args, int numArgs, out JSScriptException error);
 DllPublic JSObject* CDecl ConstructJSFunctionCreate(JSContext* context, JSFunction* function, JSValue* const* args, int numArgs, JSScriptException** outError);
@@ -298,6 +919,39 @@ DllPublic JSObject* CDecl ConstructJSFunctionCreate(JSContext* context, JSFuncti
 /// public static extern JSValue AsValue(JSFunction fun);
 DllPublic JSValue* CDecl JSFunctionAsValue(JSFunction* fun);
 
+/// // -------------------------------------------------------------------------
+/// // Unboxed
+///// Handles in arguments are borrowed; handles in results are owned by the
+///// caller and must be released.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CallJSFunctionUnboxed")]
+/// public static extern void CallUnboxed(JSContext context, JSFunction function, JSObject thisObject, [In, MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)]JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSScriptException error);
+DllPublic void CDecl CallJSFunctionUnboxed(JSContext* context, JSFunction* function, JSObject* thisObject, const JSValueUnboxed* args, int numArgs, JSValueUnboxed* outResult, JSScriptException** outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CopyJSObjectPropertyUnboxed")]
+/// public static extern void CopyPropertyUnboxed(JSContext context, JSObject obj, JSString key, out JSValueUnboxed value, out JSScriptException error);
+DllPublic void CDecl CopyJSObjectPropertyUnboxed(JSContext* context, JSObject* obj, JSString* key, JSValueUnboxed* outValue, JSScriptException** outError);
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectPropertyUnboxed")]
+/// public static extern void SetPropertyUnboxed(JSContext context, JSObject obj, JSString key, [In] ref JSValueUnboxed value, out JSScriptException error);
+DllPublic void CDecl SetJSObjectPropertyUnboxed(JSContext* context, JSObject* obj, JSString* key, const JSValueUnboxed* value, JSScriptException** outError);
+///// Gets its context the same way as CreateCallback.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSUnboxedCallback")]
+/// public static extern JSFunction CreateUnboxedCallback(JSContext context, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSUnboxedCallback callback, out JSScriptException error);
+DllPublic JSFunction* CDecl CreateJSUnboxedCallback(JSContext* context, void* data, JSUnboxedCallback callback, JSScriptException** outError);
+///// Defines a property on obj that reads and writes through native code,
+///// without a JS function in between. A null setter makes it read-only.
+///// The callbacks are passed the context of the accessing code, and access
+///// from code whose context was released throws an Error.
+/// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="SetJSObjectAccessor")]
+/// public static extern void SetAccessor(JSContext context, JSObject obj, JSString name, IntPtr data, [MarshalAs(UnmanagedType.FunctionPtr)]JSGetterCallback getter, [MarshalAs(UnmanagedType.FunctionPtr)]JSSetterCallback setter, out JSScriptException error);
+DllPublic void CDecl SetJSObjectAccessor(JSContext* context, JSObject* obj, JSString* name, void* data, JSGetterCallback getter, JSSetterCallback setter, JSScriptException** outError);
+/// public static void Release(JSContext context, JSValueUnboxed value)
+/// {
+/// 	switch (value.Type)
+/// 	{
+/// 		case JSType.Null: case JSType.Int: case JSType.Double: case JSType.Bool: break;
+/// 		default: Release(context, value.Handle); break;
+/// 	}
+/// }
+
 /// // -------------------------------------------------------------------------
 /// // External
 /// [DllImport("V8Simple.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint="CreateJSExternal")]
@@ -0,0 +1,1041 @@
+using Fuse.Scripting.V8.Simple;
+using NUnit.Framework;
+using System.Diagnostics;
+using System.Runtime.InteropServices;
+using System.Text;
+using System;
+
+// Benchmarks are explicit so that `make check` stays fast. Run them with
+// e.g. `nunit-console -labels -run=V8SimpleBenchmarks test/Test.dll`.
+[TestFixture, Explicit]
+public class V8SimpleBenchmarks
+{
+	static void CheckError(JSRuntimeError err)
+	{
+		if (err != JSRuntimeError.NoError)
+			throw new Exception("V8.Simple runtime error: " + err.ToString());
+	}
+
+	static void CheckError(JSContext context, JSScriptException err)
+	{
+		if (err != default(JSScriptException))
+		{
+			try
+			{
+				throw new Exception("V8.Simple runtime error: " + ScriptException.GetMessage(err));
+			}
+			finally
+			{
+				ScriptException.Release(context, err);
+			}
+		}
+	}
+
+	static JSString AsJSString(JSContext context, string str)
+	{
+		JSRuntimeError err;
+		var result = Value.CreateString(context, str, str.Length, out err);
+		CheckError(err);
+		return result;
+	}
+
+	static void Report(string name, int iterations, TimeSpan elapsed)
+	{
+		Console.WriteLine(
+			"{0}: {1:0.000} ms total, {2:0.000} us/iteration ({3} iterations)",
+			name,
+			elapsed.TotalMilliseconds,
+			elapsed.TotalMilliseconds * 1000.0 / iterations,
+			iterations);
+	}
+
+	static TimeSpan Measure(Action action)
+	{
+		var stopwatch = Stopwatch.StartNew();
+		action();
+		stopwatch.Stop();
+		return stopwatch.Elapsed;
+	}
+
+	static string GenerateScript(int approximateLength)
+	{
+		var sb = new StringBuilder();
+		for (int i = 0; sb.Length < approximateLength; ++i)
+		{
+			// Parenthesized so that V8 compiles the functions eagerly and they
+			// end up in the code cache.
+			sb.AppendFormat(
+				"var f{0} = (function(a, b) {{ var s = 0; for (var i = 0; i < a; ++i) {{ s += (i * b + {0}) % 7; }} return s > {0} ? 'x' + s : s; }});\n",
+				i);
+		}
+		sb.Append("f0(1, 2);\n");
+		return sb.ToString();
+	}
+
+	[Test]
+	public void CodeCacheColdVersusWarm()
+	{
+		var name = "CodeCacheColdVersusWarm";
+		var code = GenerateScript(4 * 1024 * 1024);
+		byte[] cache = null;
+
+		for (int run = 0; run < 2; ++run)
+		{
+			var context = Context.Create(null, null);
+			var jsName = AsJSString(context, name);
+			var jsCode = AsJSString(context, code);
+
+			JSCodeCache outCache = default(JSCodeCache);
+			bool rejected = false;
+			JSScriptException err = default(JSScriptException);
+			JSValue result = default(JSValue);
+			var elapsed = Measure(() =>
+			{
+				result = Context.EvaluateCachedCreate(
+					context,
+					jsName,
+					jsCode,
+					cache,
+					cache == null ? 0 : cache.Length,
+					out outCache,
+					out rejected,
+					out err);
+			});
+			CheckError(context, err);
+			Assert.IsFalse(rejected);
+
+			if (cache == null)
+			{
+				cache = CodeCache.ToArray(outCache);
+				CodeCache.Release(outCache);
+				Report("Cold compile (" + code.Length + " chars, produces " + cache.Length + " byte cache)", 1, elapsed);
+			}
+			else
+			{
+				Report("Warm compile (consumes cache)", 1, elapsed);
+			}
+
+			Value.Release(context, result);
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+			Context.Release(context);
+		}
+	}
+
+	[Test]
+	public void ScriptCompileOnceRunMany()
+	{
+		var name = "ScriptCompileOnceRunMany";
+		var iterations = 10000;
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "(function(module, exports) { var x = 0; for (var i = 0; i < 10; ++i) x += i; exports.x = x; return exports; })({}, {})");
+
+		Report("EvaluateCreate", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				JSScriptException err;
+				var result = Context.EvaluateCreate(context, jsName, jsCode, out err);
+				CheckError(context, err);
+				Value.Release(context, result);
+			}
+		}));
+
+		{
+			JSScriptException err;
+			var script = Script.Compile(context, jsName, jsCode, out err);
+			CheckError(context, err);
+			Report("Script.Run", iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+				{
+					var result = Script.Run(context, script, out err);
+					CheckError(context, err);
+					Value.Release(context, result);
+				}
+			}));
+			Script.Release(context, script);
+		}
+
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void UnboxedVersusBoxedCalls()
+	{
+		var name = "UnboxedVersusBoxedCalls";
+		var iterations = 100000;
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "(function(x, y, z) { return z ? x * y : x + y; })");
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var fun = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		// Every CreateInt/CreateDouble/CreateBool and every wrapped result is
+		// a native allocation that is later freed by Value.Release.
+		var nativeAllocations = 0;
+		var managedBytes = GC.GetAllocatedBytesForCurrentThread();
+		var args = new JSValue[3];
+		Report("Boxed CallCreate", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				args[0] = Value.CreateInt(i);
+				args[1] = Value.CreateDouble(0.5);
+				args[2] = Value.CreateBool(true);
+				var result = Value.CallCreate(context, fun, default(JSObject), args, args.Length, out err);
+				CheckError(context, err);
+				nativeAllocations += args.Length + (Value.GetType(result) == JSType.Null ? 0 : 1);
+				Value.Release(context, result);
+				foreach (var arg in args)
+					Value.Release(context, arg);
+			}
+		}));
+		Console.WriteLine(
+			"  {0:0.0} native allocations/call, {1:0.0} managed bytes/call",
+			(double)nativeAllocations / iterations,
+			(double)(GC.GetAllocatedBytesForCurrentThread() - managedBytes) / iterations);
+
+		managedBytes = GC.GetAllocatedBytesForCurrentThread();
+		var unboxedArgs = new JSValueUnboxed[3];
+		Report("Unboxed CallUnboxed", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				unboxedArgs[0] = JSValueUnboxed.FromInt(i);
+				unboxedArgs[1] = JSValueUnboxed.FromDouble(0.5);
+				unboxedArgs[2] = JSValueUnboxed.FromBool(true);
+				JSValueUnboxed result;
+				Value.CallUnboxed(context, fun, default(JSObject), unboxedArgs, unboxedArgs.Length, out result, out err);
+				CheckError(context, err);
+				Value.Release(context, result);
+			}
+		}));
+		Console.WriteLine(
+			"  0.0 native allocations/call, {0:0.0} managed bytes/call",
+			(double)(GC.GetAllocatedBytesForCurrentThread() - managedBytes) / iterations);
+
+		Value.Release(context, Value.AsValue(fun));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void BulkPropertyRead()
+	{
+		var name = "BulkPropertyRead";
+		var iterations = 10000;
+		var numFields = 20;
+		var context = Context.Create(null, null);
+
+		var code = new StringBuilder("({");
+		var keys = new JSString[numFields];
+		for (int i = 0; i < numFields; ++i)
+		{
+			code.AppendFormat("field{0}: {0}, ", i);
+			keys[i] = AsJSString(context, "field" + i);
+		}
+		code.Append("})");
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, code.ToString());
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var obj = Value.AsObject(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		Report("CopyProperty x " + numFields, iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				foreach (var key in keys)
+				{
+					var value = Value.CopyProperty(context, obj, key, out err);
+					CheckError(context, err);
+					Value.Release(context, value);
+				}
+			}
+		}));
+
+		var values = new JSValue[numFields];
+		var errors = new JSScriptException[numFields];
+		Report("CopyProperties", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				Assert.AreEqual(0, Value.CopyProperties(context, obj, keys, numFields, values, errors));
+				foreach (var value in values)
+					Value.Release(context, value);
+			}
+		}));
+
+		foreach (var key in keys)
+			Value.Release(context, Value.AsValue(key));
+		Value.Release(context, Value.AsValue(obj));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void BatchedCalls()
+	{
+		var name = "BatchedCalls";
+		var iterations = 1000;
+		var batchSize = 100;
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "(function(acc, x) { return acc + x * 2; })");
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var fun = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		var args = new JSValue[2 * batchSize];
+		for (int i = 0; i < batchSize; ++i)
+		{
+			args[2 * i] = Value.CreateInt(i);
+			args[2 * i + 1] = Value.CreateDouble(i + 0.5);
+		}
+
+		var callArgs = new JSValue[2];
+		Report("CallCreate x " + batchSize, iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				for (int j = 0; j < batchSize; ++j)
+				{
+					callArgs[0] = args[2 * j];
+					callArgs[1] = args[2 * j + 1];
+					var result = Value.CallCreate(context, fun, default(JSObject), callArgs, 2, out err);
+					CheckError(context, err);
+					Value.Release(context, result);
+				}
+			}
+		}));
+
+		var results = new JSValue[batchSize];
+		var errors = new JSScriptException[batchSize];
+		Report("CallBatch of " + batchSize, iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				Assert.AreEqual(0, Value.CallBatch(context, fun, default(JSObject), args, 2, batchSize, results, errors));
+				foreach (var result in results)
+					Value.Release(context, result);
+			}
+		}));
+
+		foreach (var arg in args)
+			Value.Release(context, arg);
+		Value.Release(context, Value.AsValue(fun));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void BulkArrayCopy()
+	{
+		var name = "BulkArrayCopy";
+		var length = 100000;
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "(function() { var a = []; for (var i = 0; i < " + length + "; ++i) a.push(i * 0.5); return a; })()");
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var arr = Value.AsArray(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		var doubles = new double[length];
+		Report("CopyProperty per element", length, Measure(() =>
+		{
+			for (int i = 0; i < length; ++i)
+			{
+				var value = Value.CopyProperty(context, arr, i, out err);
+				CheckError(context, err);
+				doubles[i] = Value.GetType(value) == JSType.Int ? Value.AsInt(value, out rerr) : Value.AsDouble(value, out rerr);
+				Value.Release(context, value);
+			}
+		}));
+		Report("CopyDoubles", length, Measure(() =>
+		{
+			Value.CopyDoubles(context, arr, 0, length, doubles, out err);
+			CheckError(context, err);
+		}));
+		Report("SetDoubles", length, Measure(() =>
+		{
+			Value.SetDoubles(context, arr, 0, length, doubles, out err);
+			CheckError(context, err);
+		}));
+
+		Value.Release(context, Value.AsValue(arr));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ArrayBufferAllocators()
+	{
+		var name = "ArrayBufferAllocators";
+		var code = "(function() { var sum = 0; for (var frame = 0; frame < 100; ++frame) { for (var i = 0; i < 1000; ++i) { var a = new Float32Array(new ArrayBuffer(16 + (i % 60) * 4)); a[0] = i; sum += a[0]; } } return sum; })()";
+		foreach (var allocatorType in new JSArrayBufferAllocatorType[] { JSArrayBufferAllocatorType.Malloc, JSArrayBufferAllocatorType.Pooled })
+		{
+			var context = Context.CreateWithArrayBufferAllocator(null, null, allocatorType);
+			var jsName = AsJSString(context, name);
+			var jsCode = AsJSString(context, code);
+
+			Report(allocatorType.ToString() + " allocator", 100 * 1000, Measure(() =>
+			{
+				JSScriptException err;
+				var result = Context.EvaluateCreate(context, jsName, jsCode, out err);
+				CheckError(context, err);
+				Value.Release(context, result);
+			}));
+
+			JSArrayBufferAllocatorStatistics statistics;
+			Context.GetArrayBufferAllocatorStatistics(context, out statistics);
+			Console.WriteLine(
+				"  live {0} bytes, peak {1} bytes, pool hit rate {2:0.0}%",
+				statistics.LiveBytes,
+				statistics.PeakBytes,
+				statistics.PoolHitRate * 100.0);
+
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+			Context.Release(context);
+		}
+	}
+
+	[Test]
+	public void Utf8StringThroughput()
+	{
+		var iterations = 1000;
+		var context = Context.Create(null, null);
+
+		var payloads = new[]
+		{
+			Tuple.Create("ASCII", new StringBuilder().Insert(0, "{\"key\": \"value\", \"n\": 12345}, ", 2000).ToString()),
+			Tuple.Create("CJK", new StringBuilder().Insert(0, "\u6f22\u5b57\u304b\u306a\u4ea4\u3058\u308a\u6587, ", 2000).ToString()),
+		};
+		foreach (var payload in payloads)
+		{
+			var text = payload.Item2;
+			var utf8 = Encoding.UTF8.GetBytes(text);
+			var label = payload.Item1 + " (" + utf8.Length + " UTF-8 bytes)";
+
+			Report(label + " UTF-8 -> UTF-16 -> CreateString", iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+				{
+					var decoded = Encoding.UTF8.GetString(utf8);
+					var str = AsJSString(context, decoded);
+					Value.Release(context, Value.AsValue(str));
+				}
+			}));
+
+			Report(label + " CreateStringFromUtf8", iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+				{
+					JSRuntimeError err;
+					var str = Value.CreateStringFromUtf8(context, utf8, utf8.Length, out err);
+					CheckError(err);
+					Value.Release(context, Value.AsValue(str));
+				}
+			}));
+
+			var jsStr = AsJSString(context, text);
+			Report(label + " ToString -> UTF-8", iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+					Encoding.UTF8.GetBytes(Value.ToString(context, jsStr));
+			}));
+
+			var buffer = new byte[utf8.Length];
+			Report(label + " WriteUtf8", iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+					Assert.AreEqual(utf8.Length, Value.WriteUtf8(context, jsStr, buffer, buffer.Length));
+			}));
+			Value.Release(context, Value.AsValue(jsStr));
+		}
+
+		Context.Release(context);
+	}
+
+	[Test]
+	public void StringRead()
+	{
+		var iterations = 100000;
+		var context = Context.Create(null, null);
+		foreach (var length in new int[] { 8, 64, 1024 })
+		{
+			var jsStr = AsJSString(context, new string('a', length));
+
+			Report("Length + Write (" + length + " chars)", iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+				{
+					var sb = new StringBuilder(Value.Length(context, jsStr) + 1);
+					Value.Write(context, jsStr, sb, true);
+					sb.ToString();
+				}
+			}));
+
+			Report("ToString via Read (" + length + " chars)", iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+					Value.ToString(context, jsStr);
+			}));
+
+			Value.Release(context, Value.AsValue(jsStr));
+		}
+		Context.Release(context);
+	}
+
+	[Test]
+	public void InternedPropertyKeys()
+	{
+		var name = "InternedPropertyKeys";
+		var iterations = 100000;
+		var context = Context.Create(null, null);
+		var names = new string[] { "length", "id", "children", "parent", "visible" };
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "({ length: 1, id: 2, children: 3, parent: 4, visible: 5 })");
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var obj = Value.AsObject(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		Report("CreateString key + CopyProperty", iterations * names.Length, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				foreach (var key in names)
+				{
+					var jsKey = AsJSString(context, key);
+					var value = Value.CopyProperty(context, obj, jsKey, out err);
+					CheckError(context, err);
+					Value.Release(context, value);
+					Value.Release(context, Value.AsValue(jsKey));
+				}
+			}
+		}));
+
+		Report("GetInternedString key + CopyProperty", iterations * names.Length, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				foreach (var key in names)
+				{
+					var jsKey = Value.GetInternedString(context, key, key.Length, out rerr);
+					CheckError(rerr);
+					var value = Value.CopyProperty(context, obj, jsKey, out err);
+					CheckError(context, err);
+					Value.Release(context, value);
+				}
+			}
+		}));
+
+		Value.Release(context, Value.AsValue(obj));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ThrowHeavyCalls()
+	{
+		var name = "ThrowHeavyCalls";
+		var iterations = 100000;
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "(function(x) { if (x % 2 == 0) throw new Error('even ' + x); return x; })");
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var fun = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		var args = new JSValue[1];
+		Report("Throwing call, message only", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				args[0] = Value.CreateInt(i);
+				var result = Value.CallCreate(context, fun, default(JSObject), args, 1, out err);
+				if (err != default(JSScriptException))
+				{
+					ScriptException.GetMessage(err);
+					ScriptException.Release(context, err);
+				}
+				Value.Release(context, result);
+				Value.Release(context, args[0]);
+			}
+		}));
+
+		Report("Throwing call, all fields", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				args[0] = Value.CreateInt(i);
+				var result = Value.CallCreate(context, fun, default(JSObject), args, 1, out err);
+				if (err != default(JSScriptException))
+				{
+					ScriptException.GetException(err);
+					ScriptException.GetMessage(err);
+					ScriptException.GetFileName(err);
+					ScriptException.GetLineNumber(err);
+					ScriptException.GetStackTrace(err);
+					ScriptException.GetSourceLine(err);
+					ScriptException.Release(context, err);
+				}
+				Value.Release(context, result);
+				Value.Release(context, args[0]);
+			}
+		}));
+
+		Value.Release(context, Value.AsValue(fun));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ThrowingCallLoop()
+	{
+		var name = "ThrowingCallLoop";
+		var iterations = 100000;
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "({ ok: function(x) { return x; }, fail: function(x) { throw x; } })");
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var obj = Value.AsObject(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		var args = new JSValueUnboxed[1];
+		foreach (var key in new string[] { "ok", "fail" })
+		{
+			var jsKey = AsJSString(context, key);
+			var fun = Value.AsFunction(Value.CopyProperty(context, obj, jsKey, out err), out rerr);
+			CheckError(context, err);
+
+			var failures = 0;
+			Report("CallUnboxed " + key, iterations, Measure(() =>
+			{
+				for (int i = 0; i < iterations; ++i)
+				{
+					args[0] = JSValueUnboxed.FromInt(i);
+					JSValueUnboxed result;
+					Value.CallUnboxed(context, fun, default(JSObject), args, 1, out result, out err);
+					if (err != default(JSScriptException))
+					{
+						++failures;
+						ScriptException.Release(context, err);
+					}
+					Value.Release(context, result);
+				}
+			}));
+			Assert.AreEqual(key == "fail" ? iterations : 0, failures);
+
+			Value.Release(context, Value.AsValue(fun));
+			Value.Release(context, Value.AsValue(jsKey));
+		}
+
+		Value.Release(context, Value.AsValue(obj));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ContextScopePropertyUpdates()
+	{
+		var name = "ContextScopePropertyUpdates";
+		var iterations = 100;
+		var numProperties = 1000;
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "({})");
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var obj = Value.AsObject(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+		var keys = new JSString[numProperties];
+		for (int i = 0; i < numProperties; ++i)
+			keys[i] = AsJSString(context, "p" + i);
+
+		Action update = () =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				for (int j = 0; j < numProperties; ++j)
+				{
+					var value = JSValueUnboxed.FromInt(i + j);
+					Value.SetPropertyUnboxed(context, obj, keys[j], ref value, out err);
+					CheckError(context, err);
+				}
+			}
+		};
+
+		Report("SetPropertyUnboxed x " + numProperties, iterations * numProperties, Measure(update));
+
+		Context.EnterScope(context);
+		Report("SetPropertyUnboxed x " + numProperties + " in EnterScope", iterations * numProperties, Measure(update));
+		Context.ExitScope(context, out rerr);
+		CheckError(rerr);
+
+		foreach (var key in keys)
+			Value.Release(context, Value.AsValue(key));
+		Value.Release(context, Value.AsValue(obj));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void IsolatePoolContextCreation()
+	{
+		var name = "IsolatePoolContextCreation";
+		var iterations = 200;
+		Action<JSContext> run = context =>
+		{
+			var jsName = AsJSString(context, name);
+			var jsCode = AsJSString(context, "JSON.stringify({ request: 1 })");
+			JSScriptException err;
+			var result = Context.EvaluateCreate(context, jsName, jsCode, out err);
+			CheckError(context, err);
+			Value.Release(context, result);
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+		};
+
+		Report("Context.Create per request", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				var context = Context.Create(null, null);
+				run(context);
+				Context.Release(context);
+			}
+		}));
+
+		JSRuntimeError rerr;
+		var pool = IsolatePool.Create(4, null, 0, JSArrayBufferAllocatorType.Malloc, out rerr);
+		CheckError(rerr);
+		Report("IsolatePool.CreateContext per request", iterations, Measure(() =>
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				var context = IsolatePool.CreateContext(pool, null, null);
+				run(context);
+				Context.Release(context);
+			}
+		}));
+
+		JSIsolatePoolStatistics statistics;
+		IsolatePool.GetStatistics(pool, out statistics);
+		Console.WriteLine(
+			"  {0} hits, {1} misses, hit rate {2:0.0}%",
+			statistics.Hits,
+			statistics.Misses,
+			statistics.HitRate * 100.0);
+		IsolatePool.Release(pool);
+	}
+
+	static readonly JSCallback _emptyCallback = (JSContext context, IntPtr data, JSValue[] args, int numArgs, out JSValue error) =>
+	{
+		error = default(JSValue);
+		return default(JSValue);
+	};
+
+	static readonly JSUnboxedCallback _emptyUnboxedCallback = (JSContext context, IntPtr data, JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		result = default(JSValueUnboxed);
+		error = default(JSValueUnboxed);
+	};
+
+	// JS-to-native calls with small arities, which fit in the trampolines'
+	// stack storage
+	[Test]
+	public void CallbackThroughput()
+	{
+		var name = "CallbackThroughput";
+		var iterations = 1000000;
+		var context = Context.Create(null, null);
+		JSScriptException err;
+		JSRuntimeError rerr;
+
+		var boxed = Value.CreateCallback(context, IntPtr.Zero, _emptyCallback, out err);
+		CheckError(context, err);
+		var unboxed = Value.CreateUnboxedCallback(context, IntPtr.Zero, _emptyUnboxedCallback, out err);
+		CheckError(context, err);
+
+		foreach (var numArgs in new[] { 0, 1, 4, 8 })
+		{
+			var argList = new StringBuilder();
+			for (int i = 0; i < numArgs; ++i)
+				argList.Append(i == 0 ? "i" : ", " + (i % 2 == 0 ? "true" : i + ".5"));
+			var jsName = AsJSString(context, name);
+			var jsCode = AsJSString(context, "(function(f, n) { for (var i = 0; i < n; ++i) f(" + argList + "); })");
+			var loop = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+			CheckError(context, err);
+
+			for (int kind = 0; kind < 2; ++kind)
+			{
+				var callback = kind == 0 ? boxed : unboxed;
+				var args = new JSValue[] { Value.AsValue(callback), Value.CreateInt(iterations) };
+				var elapsed = Measure(() =>
+				{
+					var result = Value.CallCreate(context, loop, default(JSObject), args, args.Length, out err);
+					CheckError(context, err);
+					Value.Release(context, result);
+				});
+				var label = string.Format("{0} callback, {1} args", kind == 0 ? "Boxed" : "Unboxed", numArgs);
+				Report(label, iterations, elapsed);
+				Console.WriteLine("  {0:0} calls/s", iterations / elapsed.TotalSeconds);
+				Value.Release(context, args[1]);
+			}
+
+			Value.Release(context, Value.AsValue(loop));
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+		}
+
+		Value.Release(context, Value.AsValue(unboxed));
+		Value.Release(context, Value.AsValue(boxed));
+		Context.Release(context);
+	}
+
+	delegate double TypedAdd(IntPtr data, double x, double y);
+
+	static readonly TypedAdd _typedAdd = (data, x, y) => x + y;
+
+	static double AsNumber(JSValueUnboxed value)
+	{
+		return value.Type == JSType.Int ? value.Int : value.Double;
+	}
+
+	static readonly JSUnboxedCallback _unboxedAdd = (JSContext context, IntPtr data, JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		result = JSValueUnboxed.FromDouble(AsNumber(args[0]) + AsNumber(args[1]));
+		error = default(JSValueUnboxed);
+	};
+
+	// A (double, double) -> double helper, as typed and as unboxed callback
+	[Test]
+	public void TypedVersusUnboxedCallbacks()
+	{
+		var name = "TypedVersusUnboxedCallbacks";
+		var iterations = 1000000;
+		var context = Context.Create(null, null);
+		JSScriptException err;
+		JSRuntimeError rerr;
+
+		var signature = new JSTypedSignature(JSNativeType.Double, JSNativeType.Double, JSNativeType.Double);
+		var typed = Value.CreateTypedCallback(context, IntPtr.Zero, Marshal.GetFunctionPointerForDelegate(_typedAdd), ref signature, out err);
+		CheckError(context, err);
+		var unboxed = Value.CreateUnboxedCallback(context, IntPtr.Zero, _unboxedAdd, out err);
+		CheckError(context, err);
+
+		var jsName = AsJSString(context, name);
+		var jsCode = AsJSString(context, "(function(f, n) { var s = 0.5; for (var i = 0; i < n; ++i) s = f(s, 0.25); return s; })");
+		var loop = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsCode, out err), out rerr);
+		CheckError(context, err);
+
+		for (int kind = 0; kind < 2; ++kind)
+		{
+			var args = new JSValue[] { Value.AsValue(kind == 0 ? typed : unboxed), Value.CreateInt(iterations) };
+			Report(kind == 0 ? "Typed callback" : "Unboxed callback", iterations, Measure(() =>
+			{
+				var result = Value.CallCreate(context, loop, default(JSObject), args, args.Length, out err);
+				CheckError(context, err);
+				Value.Release(context, result);
+			}));
+			Value.Release(context, args[1]);
+		}
+
+		Value.Release(context, Value.AsValue(loop));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Value.Release(context, Value.AsValue(unboxed));
+		Value.Release(context, Value.AsValue(typed));
+		Context.Release(context);
+	}
+
+	static readonly JSUnboxedCallback _closureGet = (JSContext context, IntPtr data, JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		result = JSValueUnboxed.FromInt(data.ToInt32() + args[0].Int);
+		error = default(JSValueUnboxed);
+	};
+
+	static readonly JSMethodCallback _methodGet = (JSContext context, IntPtr data, IntPtr instance, JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		result = JSValueUnboxed.FromInt(instance.ToInt32() + args[0].Int);
+		error = default(JSValueUnboxed);
+	};
+
+	// Host objects as a JS object with an external and a per-object callback,
+	// versus native class instances sharing one hidden class
+	[Test]
+	public void NativeClassHostObjects()
+	{
+		var name = "NativeClassHostObjects";
+		var numObjects = 10000;
+		var passes = 100;
+		var context = Context.Create(null, null);
+		JSScriptException err;
+		JSRuntimeError rerr;
+
+		var jsName = AsJSString(context, name);
+		var jsFactory = AsJSString(context, "(function(ext, get) { return { ext: ext, get: get }; })");
+		var factory = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsFactory, out err), out rerr);
+		CheckError(context, err);
+		var jsLoop = AsJSString(context, "(function(objects, n) { var s = 0; for (var p = 0; p < n; ++p) for (var i = 0; i < objects.length; ++i) s += objects[i].get(1); return s; })");
+		var loop = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsLoop, out err), out rerr);
+		CheckError(context, err);
+
+		var jsArray = AsJSString(context, "[]");
+		var pushName = AsJSString(context, "push");
+		var className = AsJSString(context, "Host");
+		var methodName = AsJSString(context, "get");
+		var cls = NativeClass.Create(context, className);
+		NativeClass.AddMethod(context, cls, methodName, IntPtr.Zero, _methodGet, out rerr);
+		CheckError(rerr);
+
+		for (int kind = 0; kind < 2; ++kind)
+		{
+			var objects = new JSValue[numObjects];
+			Report(kind == 0 ? "Create external host objects" : "Create native class instances", numObjects, Measure(() =>
+			{
+				for (int i = 0; i < numObjects; ++i)
+				{
+					var instance = new IntPtr(2 * i + 2);
+					if (kind == 0)
+					{
+						var external = Value.CreateExternal(context, instance);
+						var get = Value.CreateUnboxedCallback(context, instance, _closureGet, out err);
+						CheckError(context, err);
+						objects[i] = Value.CallCreate(context, factory, default(JSObject), new JSValue[] { Value.AsValue(external), Value.AsValue(get) }, 2, out err);
+						CheckError(context, err);
+						Value.Release(context, Value.AsValue(get));
+						Value.Release(context, Value.AsValue(external));
+					}
+					else
+					{
+						objects[i] = Value.AsValue(NativeClass.CreateInstance(context, cls, instance, out err));
+						CheckError(context, err);
+					}
+				}
+			}));
+
+			var array = Context.EvaluateCreate(context, jsName, jsArray, out err);
+			CheckError(context, err);
+			var arrayObject = Value.AsObject(array, out rerr);
+			var push = Value.AsFunction(Value.CopyProperty(context, arrayObject, pushName, out err), out rerr);
+			Value.Release(context, Value.CallCreate(context, push, arrayObject, objects, numObjects, out err));
+			CheckError(context, err);
+
+			var args = new JSValue[] { array, Value.CreateInt(passes) };
+			Report(kind == 0 ? "Call external host methods" : "Call native class methods", numObjects * passes, Measure(() =>
+			{
+				var result = Value.CallCreate(context, loop, default(JSObject), args, args.Length, out err);
+				CheckError(context, err);
+				Value.Release(context, result);
+			}));
+
+			Value.Release(context, args[1]);
+			Value.Release(context, Value.AsValue(push));
+			Value.Release(context, array);
+			foreach (var obj in objects)
+				Value.Release(context, obj);
+		}
+
+		NativeClass.Release(context, cls);
+		Value.Release(context, Value.AsValue(methodName));
+		Value.Release(context, Value.AsValue(className));
+		Value.Release(context, Value.AsValue(pushName));
+		Value.Release(context, Value.AsValue(jsArray));
+		Value.Release(context, Value.AsValue(loop));
+		Value.Release(context, Value.AsValue(jsLoop));
+		Value.Release(context, Value.AsValue(factory));
+		Value.Release(context, Value.AsValue(jsFactory));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	static readonly JSUnboxedCallback _shimGetter = (JSContext context, IntPtr data, JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		result = JSValueUnboxed.FromInt(42);
+		error = default(JSValueUnboxed);
+	};
+
+	static readonly JSGetterCallback _nativeGetter = (JSContext context, IntPtr data, IntPtr instance, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		result = JSValueUnboxed.FromInt(42);
+		error = default(JSValueUnboxed);
+	};
+
+	// Property reads through an Object.defineProperty getter wrapping a
+	// callback, versus a native accessor
+	[Test]
+	public void AccessorReads()
+	{
+		var name = "AccessorReads";
+		var iterations = 1000000;
+		var context = Context.Create(null, null);
+		JSScriptException err;
+		JSRuntimeError rerr;
+
+		var jsName = AsJSString(context, name);
+		var propertyName = AsJSString(context, "value");
+		var jsShim = AsJSString(context, "(function(get) { var o = {}; Object.defineProperty(o, 'value', { get: get }); return o; })");
+		var shim = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsShim, out err), out rerr);
+		CheckError(context, err);
+		var jsLoop = AsJSString(context, "(function(o, n) { var s = 0; for (var i = 0; i < n; ++i) s += o.value; return s; })");
+		var loop = Value.AsFunction(Context.EvaluateCreate(context, jsName, jsLoop, out err), out rerr);
+		CheckError(context, err);
+
+		var getter = Value.CreateUnboxedCallback(context, IntPtr.Zero, _shimGetter, out err);
+		CheckError(context, err);
+		var shimmed = Value.CallCreate(context, shim, default(JSObject), new JSValue[] { Value.AsValue(getter) }, 1, out err);
+		CheckError(context, err);
+		var jsObject = AsJSString(context, "({})");
+		var native = Context.EvaluateCreate(context, jsName, jsObject, out err);
+		CheckError(context, err);
+		Value.SetAccessor(context, Value.AsObject(native, out rerr), propertyName, IntPtr.Zero, _nativeGetter, null, out err);
+		CheckError(context, err);
+
+		var count = Value.CreateInt(iterations);
+		for (int kind = 0; kind < 2; ++kind)
+		{
+			var args = new JSValue[] { kind == 0 ? shimmed : native, count };
+			Report(kind == 0 ? "defineProperty getter" : "Native accessor", iterations, Measure(() =>
+			{
+				var result = Value.CallCreate(context, loop, default(JSObject), args, args.Length, out err);
+				CheckError(context, err);
+				Value.Release(context, result);
+			}));
+		}
+
+		Value.Release(context, count);
+		Value.Release(context, native);
+		Value.Release(context, Value.AsValue(jsObject));
+		Value.Release(context, shimmed);
+		Value.Release(context, Value.AsValue(getter));
+		Value.Release(context, Value.AsValue(loop));
+		Value.Release(context, Value.AsValue(jsLoop));
+		Value.Release(context, Value.AsValue(shim));
+		Value.Release(context, Value.AsValue(jsShim));
+		Value.Release(context, Value.AsValue(propertyName));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+}
@@ -391,6 +391,273 @@ public class V8SimpleTests
 		Context.Release(context);
 	}
 
+	// Arities past the trampoline's stack storage, and shared boxes for
+	// booleans and small ints that outlive the call
+	[Test]
+	public void CallbackArities()
+	{
+		JSScriptException err;
+		var testName = "CallbackArities";
+		var context = Context.Create(_callbackFinalizer, _externalFinalizer);
+
+		var f = AsFunction(Eval(context, testName, "(function(f) { return f(1, 2, 3, 4, 5, 6, 7, 8, 9, 1000, true, false) + f(0, true); })"));
+
+		var kept = new List<JSValue>();
+		var cb = CreateCallback(context, (cxt, args) =>
+		{
+			var sum = 0;
+			foreach (var arg in args)
+			{
+				Value.Retain(cxt, arg);
+				kept.Add(arg);
+				sum += Value.GetType(arg) == JSType.Bool ? (AsBool(arg) ? 10000 : 0) : AsInt(arg);
+			}
+			return Value.CreateInt(sum);
+		});
+
+		var result = Value.CallCreate(context, f, default(JSObject), new JSValue[] { Value.AsValue(cb) }, 1, out err);
+		CheckError(context, err);
+		Assert.AreEqual(1045 + 10000 + 10000, AsInt(result));
+		Assert.AreEqual(14, kept.Count);
+		Assert.IsTrue(AsBool(kept[10]));
+		Assert.AreEqual(9, AsInt(kept[8]));
+
+		foreach (var arg in kept)
+			Value.Release(context, arg);
+		Value.Release(context, result);
+		Value.Release(context, Value.AsValue(cb));
+		Value.Release(context, Value.AsValue(f));
+		Context.Release(context);
+	}
+
+	delegate double TypedHypot(IntPtr data, double x, double y);
+	delegate void TypedStore(IntPtr data, int value);
+
+	static readonly TypedHypot _typedHypot = (data, x, y) => Math.Sqrt(x * x + y * y);
+	static int _typedStored;
+	static readonly TypedStore _typedStore = (data, value) => _typedStored = value + data.ToInt32();
+
+	[Test]
+	public void TypedCallbacks()
+	{
+		JSScriptException err;
+		var testName = "TypedCallbacks";
+		var context = Context.Create(_callbackFinalizer, _externalFinalizer);
+
+		var hypotSignature = new JSTypedSignature(JSNativeType.Double, JSNativeType.Double, JSNativeType.Double);
+		var hypot = Value.CreateTypedCallback(context, IntPtr.Zero, Marshal.GetFunctionPointerForDelegate(_typedHypot), ref hypotSignature, out err);
+		CheckError(context, err);
+		var storeSignature = new JSTypedSignature(JSNativeType.Void, JSNativeType.Int);
+		var store = Value.CreateTypedCallback(context, new IntPtr(1000), Marshal.GetFunctionPointerForDelegate(_typedStore), ref storeSignature, out err);
+		CheckError(context, err);
+
+		var f = AsFunction(Eval(context, testName, "(function(hypot, store) { store('41'); return [hypot(3, 4), hypot.length, store(7.9), store({ valueOf: function() { throw 'no'; } })]; })"));
+		var result = Value.CallCreate(context, f, default(JSObject), new JSValue[] { Value.AsValue(hypot), Value.AsValue(store) }, 2, out err);
+		Assert.AreEqual(default(JSValue), result);
+		Assert.AreEqual("no", AsString(context, ScriptException.GetException(err)));
+		ScriptException.Release(context, err);
+		Assert.AreEqual(1007, _typedStored);
+
+		var g = AsFunction(Eval(context, testName, "(function(hypot) { return hypot(3, 4) + hypot.length; })"));
+		result = Value.CallCreate(context, g, default(JSObject), new JSValue[] { Value.AsValue(hypot) }, 1, out err);
+		CheckError(context, err);
+		Assert.AreEqual(7, AsInt(result));
+		Value.Release(context, result);
+
+		var badSignature = new JSTypedSignature(JSNativeType.Int, JSNativeType.Bool);
+		var bad = Value.CreateTypedCallback(context, IntPtr.Zero, Marshal.GetFunctionPointerForDelegate(_typedStore), ref badSignature, out err);
+		Assert.AreEqual(default(JSFunction), bad);
+		Assert.AreNotEqual(default(JSScriptException), err);
+		ScriptException.Release(context, err);
+
+		Value.Release(context, Value.AsValue(g));
+		Value.Release(context, Value.AsValue(f));
+		Value.Release(context, Value.AsValue(store));
+		Value.Release(context, Value.AsValue(hypot));
+		Context.Release(context);
+	}
+
+	static JSContext _scaledContext;
+
+	static readonly JSMethodCallback _scaledMethod = (JSContext context, IntPtr data, IntPtr instance, JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		_scaledContext = context;
+		var value = (int)GCHandle.FromIntPtr(instance).Target;
+		result = JSValueUnboxed.FromInt(value * args[0].Int);
+		error = default(JSValueUnboxed);
+	};
+
+	[Test]
+	public void NativeClasses()
+	{
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var testName = "NativeClasses";
+		var context = Context.Create(_callbackFinalizer, _externalFinalizer);
+
+		var className = AsJSString(context, "Scalar");
+		var methodName = AsJSString(context, "scaled");
+		var cls = NativeClass.Create(context, className);
+		NativeClass.AddMethod(context, cls, methodName, GCHandle.ToIntPtr(GCHandle.Alloc(testName)), _scaledMethod, out rerr);
+		CheckError(rerr);
+
+		var eight = GCHandle.ToIntPtr(GCHandle.Alloc(8));
+		var a = NativeClass.CreateInstance(context, cls, eight, out err);
+		CheckError(context, err);
+		var b = NativeClass.CreateInstance(context, cls, GCHandle.ToIntPtr(GCHandle.Alloc(16)), out err);
+		CheckError(context, err);
+		var constructor = NativeClass.GetConstructor(context, cls, out err);
+		CheckError(context, err);
+
+		NativeClass.AddMethod(context, cls, methodName, IntPtr.Zero, _scaledMethod, out rerr);
+		Assert.AreEqual(JSRuntimeError.TypeError, rerr);
+		Assert.AreEqual(eight, NativeClass.GetInstance(context, cls, a, out rerr));
+		CheckError(rerr);
+
+		var f = AsFunction(Eval(context, testName, "(function(a, b, Scalar) { return a instanceof Scalar && Object.getPrototypeOf(a) === Object.getPrototypeOf(b) ? a.scaled(2) + b.scaled(3) : -1; })"));
+		var result = Value.CallCreate(context, f, default(JSObject), new JSValue[] { Value.AsValue(a), Value.AsValue(b), Value.AsValue(constructor) }, 3, out err);
+		CheckError(context, err);
+		Assert.AreEqual(8 * 2 + 16 * 3, AsInt(result));
+		Value.Release(context, result);
+
+		// Methods reject other receivers
+		var g = AsFunction(Eval(context, testName, "(function(a) { return a.scaled.call({}, 1); })"));
+		result = Value.CallCreate(context, g, default(JSObject), new JSValue[] { Value.AsValue(a) }, 1, out err);
+		Assert.AreEqual(default(JSValue), result);
+		Assert.AreNotEqual(default(JSScriptException), err);
+		ScriptException.Release(context, err);
+
+		var plain = AsObject(Eval(context, testName, "({})"));
+		Assert.AreEqual(IntPtr.Zero, NativeClass.GetInstance(context, cls, plain, out rerr));
+		Assert.AreEqual(JSRuntimeError.InvalidCast, rerr);
+
+		// The class is bound to its context, even on a shared isolate
+		var isolate = Context.GetIsolate(context);
+		var other = Isolate.CreateContext(isolate, _callbackFinalizer, _externalFinalizer);
+		Assert.AreEqual(IntPtr.Zero, NativeClass.GetInstance(other, cls, a, out rerr));
+		Assert.AreEqual(JSRuntimeError.WrongContext, rerr);
+		Assert.AreEqual(default(JSObject), NativeClass.CreateInstance(other, cls, eight, out err));
+		Assert.AreNotEqual(default(JSScriptException), err);
+		ScriptException.Release(other, err);
+
+		// Methods run in the context of their function, even when called
+		// from another context
+		_scaledContext = default(JSContext);
+		var h = AsFunction(Eval(other, testName, "(function(a) { return a.scaled(1); })"));
+		result = Value.CallCreate(other, h, default(JSObject), new JSValue[] { Value.AsValue(a) }, 1, out err);
+		CheckError(other, err);
+		Assert.AreEqual(8, AsInt(result));
+		Assert.AreEqual(context, _scaledContext);
+		Value.Release(other, result);
+		var hold = AsFunction(Eval(other, testName, "(function(a) { this.held = a; })"));
+		result = Value.CallCreate(other, hold, default(JSObject), new JSValue[] { Value.AsValue(a) }, 1, out err);
+		CheckError(other, err);
+		Value.Release(other, result);
+
+		Value.Release(context, Value.AsValue(plain));
+		Value.Release(context, Value.AsValue(g));
+		Value.Release(context, Value.AsValue(f));
+		Value.Release(context, Value.AsValue(constructor));
+		Value.Release(context, Value.AsValue(b));
+		Value.Release(context, Value.AsValue(a));
+		NativeClass.Release(context, cls);
+		Value.Release(context, Value.AsValue(methodName));
+		Value.Release(context, Value.AsValue(className));
+		Context.Release(context);
+
+		// Methods throw once the class's context is gone
+		result = Eval(other, testName, "held.scaled('x')", out err);
+		Assert.AreEqual(default(JSValue), result);
+		Assert.AreNotEqual(default(JSScriptException), err);
+		ScriptException.Release(other, err);
+
+		Value.Release(other, Value.AsValue(hold));
+		Value.Release(other, Value.AsValue(h));
+		Context.Release(other);
+	}
+
+	static int _accessorField;
+
+	static readonly JSGetterCallback _fieldGetter = (JSContext context, IntPtr data, IntPtr instance, out JSValueUnboxed result, out JSValueUnboxed error) =>
+	{
+		result = JSValueUnboxed.FromInt(instance == IntPtr.Zero ? _accessorField : (int)GCHandle.FromIntPtr(instance).Target);
+		error = default(JSValueUnboxed);
+	};
+
+	static readonly JSSetterCallback _fieldSetter = (JSContext context, IntPtr data, IntPtr instance, ref JSValueUnboxed value, out JSValueUnboxed error) =>
+	{
+		error = default(JSValueUnboxed);
+		if (value.Type == JSType.Int)
+			_accessorField = value.Int;
+		else
+			error = JSValueUnboxed.FromInt(-1);
+	};
+
+	[Test]
+	public void NativeAccessors()
+	{
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var testName = "NativeAccessors";
+		var context = Context.Create(_callbackFinalizer, _externalFinalizer);
+		var name = AsJSString(context, "field");
+		_accessorField = 5;
+
+		var obj = AsObject(Eval(context, testName, "({})"));
+		Value.SetAccessor(context, obj, name, GCHandle.ToIntPtr(GCHandle.Alloc(testName)), _fieldGetter, _fieldSetter, out err);
+		CheckError(context, err);
+		var f = AsFunction(Eval(context, testName, "(function(o) { var before = o.field; o.field = 37; try { o.field = 'x'; } catch (e) { before += e; } return before + o.field; })"));
+		var result = Value.CallCreate(context, f, default(JSObject), new JSValue[] { Value.AsValue(obj) }, 1, out err);
+		CheckError(context, err);
+		Assert.AreEqual(5 - 1 + 37, AsInt(result));
+		Assert.AreEqual(37, _accessorField);
+		Value.Release(context, result);
+
+		// Read-only on native class instances
+		var className = AsJSString(context, "Holder");
+		var cls = NativeClass.Create(context, className);
+		NativeClass.AddAccessor(context, cls, name, GCHandle.ToIntPtr(GCHandle.Alloc(testName)), _fieldGetter, null, out rerr);
+		CheckError(rerr);
+		var instance = NativeClass.CreateInstance(context, cls, GCHandle.ToIntPtr(GCHandle.Alloc(42)), out err);
+		CheckError(context, err);
+		var g = AsFunction(Eval(context, testName, "(function(o) { o.field = 1; return o.field; })"));
+		result = Value.CallCreate(context, g, default(JSObject), new JSValue[] { Value.AsValue(instance) }, 1, out err);
+		CheckError(context, err);
+		Assert.AreEqual(42, AsInt(result));
+		Assert.AreEqual(37, _accessorField);
+		Value.Release(context, result);
+
+		// Accessors throw when reached from code of a released context
+		var other = Isolate.CreateContext(Context.GetIsolate(context), _callbackFinalizer, _externalFinalizer);
+		var access = Eval(context, testName, "({ get: function(o) { return o.field; }, set: function(o) { o.field = {}; } })");
+		var hold = AsFunction(Eval(other, testName, "(function(access, o, instance) { this.access = access; this.o = o; this.instance = instance; })"));
+		result = Value.CallCreate(other, hold, default(JSObject), new JSValue[] { access, Value.AsValue(obj), Value.AsValue(instance) }, 3, out err);
+		CheckError(other, err);
+		Value.Release(other, result);
+
+		Value.Release(context, access);
+		Value.Release(context, Value.AsValue(g));
+		Value.Release(context, Value.AsValue(instance));
+		NativeClass.Release(context, cls);
+		Value.Release(context, Value.AsValue(className));
+		Value.Release(context, Value.AsValue(f));
+		Value.Release(context, Value.AsValue(obj));
+		Value.Release(context, Value.AsValue(name));
+		Context.Release(context);
+
+		foreach (var code in new string[] { "access.get(o)", "access.set(o)", "access.get(instance)" })
+		{
+			result = Eval(other, testName, code, out err);
+			Assert.AreEqual(default(JSValue), result);
+			Assert.AreNotEqual(default(JSScriptException), err);
+			ScriptException.Release(other, err);
+		}
+		Assert.AreEqual(37, _accessorField);
+
+		Value.Release(other, Value.AsValue(hold));
+		Context.Release(other);
+	}
+
 	[Test]
 	public void CallbackExceptions()
 	{
@@ -666,4 +933,1003 @@ public class V8SimpleTests
 
 		Context.Release(context);
 	}
+
+	[Test]
+	public void CodeCaches()
+	{
+		var testName = "CodeCaches";
+		var code = "(function(x) { return x * 2; })(21)";
+		byte[] cache;
+		byte[] otherCache;
+		byte[] replacedCache;
+		{
+			var context = Context.Create(null, null);
+			var jsName = AsJSString(context, testName);
+			var jsCode = AsJSString(context, code);
+			JSCodeCache outCache;
+			bool rejected;
+			JSScriptException err;
+			var result = Context.EvaluateCachedCreate(context, jsName, jsCode, null, 0, out outCache, out rejected, out err);
+			CheckError(context, err);
+			Assert.AreEqual(42, AsInt(result));
+			Assert.IsFalse(rejected);
+			Assert.AreNotEqual(default(JSCodeCache), outCache);
+			cache = CodeCache.ToArray(outCache);
+			CodeCache.Release(outCache);
+			Value.Release(context, result);
+
+			var otherCode = AsJSString(context, "1 + 1");
+			result = Context.EvaluateCachedCreate(context, jsName, otherCode, null, 0, out outCache, out rejected, out err);
+			CheckError(context, err);
+			otherCache = CodeCache.ToArray(outCache);
+			CodeCache.Release(outCache);
+			Value.Release(context, result);
+			Value.Release(context, Value.AsValue(otherCode));
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+			Context.Release(context);
+		}
+		{
+			var context = Context.Create(null, null);
+			var jsName = AsJSString(context, testName);
+			var jsCode = AsJSString(context, code);
+			JSCodeCache outCache;
+			bool rejected;
+			JSScriptException err;
+			var result = Context.EvaluateCachedCreate(context, jsName, jsCode, cache, cache.Length, out outCache, out rejected, out err);
+			CheckError(context, err);
+			Assert.AreEqual(42, AsInt(result));
+			Assert.IsFalse(rejected);
+			Assert.AreEqual(default(JSCodeCache), outCache);
+			Value.Release(context, result);
+
+			// A cache from another V8 version is rejected and replaced
+			var staleCache = (byte[])cache.Clone();
+			staleCache[0] ^= 0xff;
+			result = Context.EvaluateCachedCreate(context, jsName, jsCode, staleCache, staleCache.Length, out outCache, out rejected, out err);
+			CheckError(context, err);
+			Assert.AreEqual(42, AsInt(result));
+			Assert.IsTrue(rejected);
+			Assert.AreNotEqual(default(JSCodeCache), outCache);
+			CodeCache.Release(outCache);
+			Value.Release(context, result);
+
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+			Context.Release(context);
+		}
+		{
+			// So is a cache made for other code
+			var context = Context.Create(null, null);
+			var jsName = AsJSString(context, testName);
+			var jsCode = AsJSString(context, code);
+			JSCodeCache outCache;
+			bool rejected;
+			JSScriptException err;
+			var result = Context.EvaluateCachedCreate(context, jsName, jsCode, otherCache, otherCache.Length, out outCache, out rejected, out err);
+			CheckError(context, err);
+			Assert.AreEqual(42, AsInt(result));
+			Assert.IsTrue(rejected);
+			Assert.AreNotEqual(default(JSCodeCache), outCache);
+			replacedCache = CodeCache.ToArray(outCache);
+			CodeCache.Release(outCache);
+			Value.Release(context, result);
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+			Context.Release(context);
+		}
+		{
+			// The replacement is accepted next time
+			var context = Context.Create(null, null);
+			var jsName = AsJSString(context, testName);
+			var jsCode = AsJSString(context, code);
+			JSCodeCache outCache;
+			bool rejected;
+			JSScriptException err;
+			var result = Context.EvaluateCachedCreate(context, jsName, jsCode, replacedCache, replacedCache.Length, out outCache, out rejected, out err);
+			CheckError(context, err);
+			Assert.AreEqual(42, AsInt(result));
+			Assert.IsFalse(rejected);
+			Assert.AreEqual(default(JSCodeCache), outCache);
+			Value.Release(context, result);
+			Value.Release(context, Value.AsValue(jsCode));
+			Value.Release(context, Value.AsValue(jsName));
+			Context.Release(context);
+		}
+	}
+
+	[Test]
+	public void Scripts()
+	{
+		var testName = "Scripts";
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, testName);
+		var jsCode = AsJSString(context, "this.counter = (this.counter || 0) + 1");
+
+		JSScriptException err;
+		var script = Script.Compile(context, jsName, jsCode, out err);
+		CheckError(context, err);
+
+		for (int i = 1; i <= 3; ++i)
+		{
+			var result = Script.Run(context, script, out err);
+			CheckError(context, err);
+			Assert.AreEqual(i, AsInt(result));
+			Value.Release(context, result);
+		}
+
+		var badCode = AsJSString(context, "new ....");
+		Assert.AreEqual(default(JSScript), Script.Compile(context, jsName, badCode, out err));
+		Assert.AreNotEqual(default(JSScriptException), err);
+		ScriptException.Release(context, err);
+
+		Value.Release(context, Value.AsValue(badCode));
+		Script.Release(context, script);
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void Snapshots()
+	{
+		var testName = "Snapshots";
+		JSRuntimeError err;
+
+		var bootstrap = "var bootstrapped = { answer: 40 + 2 };";
+		var snapshot = Snapshot.Create(bootstrap, bootstrap.Length, out err);
+		CheckError(err);
+		var blob = Snapshot.ToArray(snapshot);
+		Snapshot.Release(snapshot);
+
+		{
+			var context = Context.CreateFromSnapshot(null, null, blob, blob.Length, out err);
+			CheckError(err);
+			var result = Eval(context, testName, "bootstrapped.answer");
+			Assert.AreEqual(42, AsInt(result));
+			Value.Release(context, result);
+			Context.Release(context);
+		}
+		{
+			var throwing = "throw new Error('bootstrap failed');";
+			Assert.AreEqual(default(JSSnapshot), Snapshot.Create(throwing, throwing.Length, out err));
+			Assert.AreEqual(JSRuntimeError.ScriptError, err);
+		}
+		{
+			var staleBlob = (byte[])blob.Clone();
+			staleBlob[0] ^= 0xff;
+			Assert.AreEqual(default(JSContext), Context.CreateFromSnapshot(null, null, staleBlob, staleBlob.Length, out err));
+			Assert.AreEqual(JSRuntimeError.SnapshotError, err);
+		}
+	}
+
+	static void CallUnboxedCallback(JSContext context, IntPtr data, JSValueUnboxed[] args, int numArgs, out JSValueUnboxed result, out JSValueUnboxed error)
+	{
+		error = default(JSValueUnboxed);
+		result = JSValueUnboxed.FromDouble(args[0].Int * args[1].Double + (args[2].Bool ? 1 : 0));
+	}
+
+	readonly JSUnboxedCallback _unboxedCallback = CallUnboxedCallback;
+
+	[Test]
+	public void Unboxed()
+	{
+		var testName = "Unboxed";
+		var context = Context.Create(null, null);
+		JSScriptException err;
+
+		{
+			var fun = AsFunction(Eval(context, testName, "(function(x, y, z, s) { return z ? x * y : s; })"));
+			var str = AsJSString(context, "abc");
+			var args = new JSValueUnboxed[]
+			{
+				JSValueUnboxed.FromInt(11),
+				JSValueUnboxed.FromDouble(1.5),
+				JSValueUnboxed.FromBool(true),
+				JSValueUnboxed.FromValue(Value.AsValue(str)),
+			};
+			JSValueUnboxed result;
+			Value.CallUnboxed(context, fun, default(JSObject), args, args.Length, out result, out err);
+			CheckError(context, err);
+			Assert.AreEqual(JSType.Double, result.Type);
+			Assert.AreEqual(16.5, result.Double);
+
+			args[2] = JSValueUnboxed.FromBool(false);
+			Value.CallUnboxed(context, fun, default(JSObject), args, args.Length, out result, out err);
+			CheckError(context, err);
+			Assert.AreEqual("abc", AsString(context, result.Handle));
+			Value.Release(context, result);
+
+			Value.Release(context, Value.AsValue(str));
+			Value.Release(context, Value.AsValue(fun));
+		}
+		{
+			var obj = AsObject(Eval(context, testName, "({ a: 123 })"));
+			var a = AsJSString(context, "a");
+			var b = AsJSString(context, "b");
+			JSValueUnboxed result;
+			Value.CopyPropertyUnboxed(context, obj, a, out result, out err);
+			CheckError(context, err);
+			Assert.AreEqual(JSType.Int, result.Type);
+			Assert.AreEqual(123, result.Int);
+
+			var value = JSValueUnboxed.FromBool(true);
+			Value.SetPropertyUnboxed(context, obj, b, ref value, out err);
+			CheckError(context, err);
+			Value.CopyPropertyUnboxed(context, obj, b, out result, out err);
+			CheckError(context, err);
+			Assert.AreEqual(JSType.Bool, result.Type);
+			Assert.IsTrue(result.Bool);
+
+			Value.Release(context, Value.AsValue(b));
+			Value.Release(context, Value.AsValue(a));
+			Value.Release(context, Value.AsValue(obj));
+		}
+		{
+			var f = AsFunction(Eval(context, testName, "(function(f) { return f(3, 0.5, true); })"));
+			var cb = Value.CreateUnboxedCallback(context, IntPtr.Zero, _unboxedCallback, out err);
+			CheckError(context, err);
+			var result = Value.CallCreate(context, f, default(JSObject), new JSValue[] { Value.AsValue(cb) }, 1, out err);
+			CheckError(context, err);
+			Assert.AreEqual(2.5, AsDouble(result));
+			Value.Release(context, result);
+			Value.Release(context, Value.AsValue(cb));
+			Value.Release(context, Value.AsValue(f));
+		}
+
+		Context.Release(context);
+	}
+
+	[Test]
+	public void BulkProperties()
+	{
+		var testName = "BulkProperties";
+		var context = Context.Create(null, null);
+
+		var obj = AsObject(Eval(context, testName, "({ a: \"abc\", b: 123, get c() { throw \"c\"; }, set d(x) { throw \"d\"; } })"));
+		var keys = new JSString[] { AsJSString(context, "a"), AsJSString(context, "b"), AsJSString(context, "c"), AsJSString(context, "d") };
+		var values = new JSValue[keys.Length];
+		var errors = new JSScriptException[keys.Length];
+
+		Assert.AreEqual(1, Value.CopyProperties(context, obj, keys, keys.Length, values, errors));
+		Assert.AreEqual("abc", AsString(context, values[0]));
+		Assert.AreEqual(123, AsInt(values[1]));
+		Assert.AreEqual(default(JSValue), values[2]);
+		Assert.AreNotEqual(default(JSScriptException), errors[2]);
+		Assert.AreEqual("c", AsString(context, ScriptException.GetException(errors[2])));
+		Assert.AreEqual(default(JSScriptException), errors[3]);
+		foreach (var value in values)
+			Value.Release(context, value);
+		ScriptException.Release(context, errors[2]);
+
+		values = new JSValue[] { Value.CreateInt(1), Value.CreateInt(2), Value.CreateInt(3), Value.CreateInt(4) };
+		Assert.AreEqual(1, Value.SetProperties(context, obj, keys, values, keys.Length, errors));
+		Assert.AreEqual(default(JSScriptException), errors[0]);
+		Assert.AreEqual(default(JSScriptException), errors[1]);
+		Assert.AreEqual(default(JSScriptException), errors[2]);
+		Assert.AreNotEqual(default(JSScriptException), errors[3]);
+		Assert.AreEqual("d", AsString(context, ScriptException.GetException(errors[3])));
+		ScriptException.Release(context, errors[3]);
+
+		JSScriptException err;
+		var b = Value.CopyProperty(context, obj, keys[1], out err);
+		CheckError(context, err);
+		Assert.AreEqual(2, AsInt(b));
+		Value.Release(context, b);
+
+		foreach (var value in values)
+			Value.Release(context, value);
+		foreach (var key in keys)
+			Value.Release(context, Value.AsValue(key));
+		Value.Release(context, Value.AsValue(obj));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void BatchCalls()
+	{
+		var testName = "BatchCalls";
+		var context = Context.Create(null, null);
+
+		var f = AsFunction(Eval(context, testName, "(function(x, y) { if (y === 0) throw 'zero'; return x / y; })"));
+		var args = new JSValue[] { Value.CreateInt(8), Value.CreateInt(2), Value.CreateInt(1), Value.CreateInt(0), Value.CreateInt(9), Value.CreateInt(3) };
+		var results = new JSValue[3];
+		var errors = new JSScriptException[3];
+
+		Assert.AreEqual(1, Value.CallBatch(context, f, default(JSObject), args, 2, 3, results, errors));
+		Assert.AreEqual(4, AsInt(results[0]));
+		Assert.AreEqual(default(JSValue), results[1]);
+		Assert.AreEqual("zero", AsString(context, ScriptException.GetException(errors[1])));
+		Assert.AreEqual(3, AsInt(results[2]));
+		Assert.AreEqual(default(JSScriptException), errors[0]);
+		Assert.AreEqual(default(JSScriptException), errors[2]);
+		ScriptException.Release(context, errors[1]);
+
+		Assert.AreEqual(-1, Value.CallBatch(context, f, default(JSObject), args, -1, 3, new JSValue[3], new JSScriptException[3]));
+		Assert.AreEqual(-1, Value.CallBatch(context, f, default(JSObject), args, 2, -1, new JSValue[3], new JSScriptException[3]));
+
+		foreach (var result in results)
+			Value.Release(context, result);
+		foreach (var arg in args)
+			Value.Release(context, arg);
+		Value.Release(context, Value.AsValue(f));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ArrayRanges()
+	{
+		var testName = "ArrayRanges";
+		var context = Context.Create(null, null);
+		var arr = AsArray(Eval(context, testName, "[\"abc\", 1, 2.5, 3, 4]"));
+		JSScriptException err;
+
+		{
+			var values = new JSValue[2];
+			Value.CopyRange(context, arr, 0, 2, values, out err);
+			CheckError(context, err);
+			Assert.AreEqual("abc", AsString(context, values[0]));
+			Assert.AreEqual(1, AsInt(values[1]));
+			foreach (var value in values)
+				Value.Release(context, value);
+		}
+		{
+			var doubles = new double[3];
+			Value.CopyDoubles(context, arr, 1, 3, doubles, out err);
+			CheckError(context, err);
+			Assert.AreEqual(new double[] { 1, 2.5, 3 }, doubles);
+
+			var ints = new int[3];
+			Value.CopyInts(context, arr, 2, 3, ints, out err);
+			CheckError(context, err);
+			Assert.AreEqual(new int[] { 2, 3, 4 }, ints);
+		}
+		{
+			Value.SetDoubles(context, arr, 5, 2, new double[] { 0.5, 1.5 }, out err);
+			CheckError(context, err);
+			Value.SetInts(context, arr, 0, 1, new int[] { 42 }, out err);
+			CheckError(context, err);
+			var values = new JSValue[] { Value.CreateBool(true) };
+			Value.SetRange(context, arr, 7, 1, values, out err);
+			CheckError(context, err);
+			Value.Release(context, values[0]);
+
+			Assert.AreEqual(8, Value.Length(context, arr));
+			var doubles = new double[8];
+			Value.CopyDoubles(context, arr, 0, 8, doubles, out err);
+			CheckError(context, err);
+			Assert.AreEqual(new double[] { 42, 1, 2.5, 3, 4, 0.5, 1.5, 1 }, doubles);
+		}
+
+		Value.Release(context, Value.AsValue(arr));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ArrayBufferViews()
+	{
+		var testName = "ArrayBufferViews";
+		var context = Context.Create(null, null);
+		JSRuntimeError rerr;
+		JSScriptException err;
+
+		var floats = new float[] { 1.5f, 2.5f, 3.5f, 4.5f };
+		var handle = GCHandle.Alloc(floats, GCHandleType.Pinned);
+		{
+			var view = Value.CreateExternalArrayBufferView(context, JSArrayBufferViewType.Float32Array, handle.AddrOfPinnedObject(), floats.Length, out rerr);
+			CheckError(rerr);
+
+			var sum = AsFunction(Eval(context, testName, "(function(a) { a[0] = 10; var s = 0; for (var i = 0; i < a.length; ++i) s += a[i]; return s; })"));
+			var result = Value.CallCreate(context, sum, default(JSObject), new JSValue[] { Value.AsValue(view) }, 1, out err);
+			CheckError(context, err);
+			Assert.AreEqual(20.5, AsDouble(result));
+			Assert.AreEqual(10.0f, floats[0]);
+			Value.Release(context, result);
+
+			JSArrayBufferViewType type;
+			int byteOffset, byteLength;
+			var data = Value.GetArrayBufferViewData(context, view, out type, out byteOffset, out byteLength, out rerr);
+			CheckError(rerr);
+			Assert.AreEqual(handle.AddrOfPinnedObject(), data);
+			Assert.AreEqual(JSArrayBufferViewType.Float32Array, type);
+			Assert.AreEqual(0, byteOffset);
+			Assert.AreEqual(floats.Length * sizeof(float), byteLength);
+
+			var buffer = Value.CopyArrayBufferViewBuffer(context, view, out rerr);
+			CheckError(rerr);
+			Assert.AreEqual(floats.Length * sizeof(float), Value.GetArrayBufferByteLength(context, buffer, out rerr));
+			CheckError(rerr);
+
+			var ints = Value.CreateArrayBufferView(context, buffer, JSArrayBufferViewType.Int32Array, 4, 2, out rerr);
+			CheckError(rerr);
+			data = Value.GetArrayBufferViewData(context, ints, out type, out byteOffset, out byteLength, out rerr);
+			CheckError(rerr);
+			Assert.AreEqual(JSArrayBufferViewType.Int32Array, type);
+			Assert.AreEqual(4, byteOffset);
+			Assert.AreEqual(8, byteLength);
+			Assert.AreEqual(BitConverter.ToInt32(BitConverter.GetBytes(floats[1]), 0), Marshal.ReadInt32(data));
+
+			Assert.AreEqual(default(JSObject), Value.CreateArrayBufferView(context, buffer, JSArrayBufferViewType.Float64Array, 4, 1, out rerr));
+			Assert.AreEqual(JSRuntimeError.RangeError, rerr);
+			Assert.AreEqual(default(JSObject), Value.CreateArrayBufferView(context, buffer, JSArrayBufferViewType.Uint8Array, 0, 17, out rerr));
+			Assert.AreEqual(JSRuntimeError.RangeError, rerr);
+
+			Value.Release(context, Value.AsValue(ints));
+			Value.Release(context, Value.AsValue(buffer));
+			Value.Release(context, Value.AsValue(sum));
+			Value.Release(context, Value.AsValue(view));
+		}
+		{
+			var view = AsObject(Eval(context, testName, "new Float64Array([1, 2, 3, 4]).subarray(1, 3)"));
+			JSArrayBufferViewType type;
+			int byteOffset, byteLength;
+			var data = Value.GetArrayBufferViewData(context, view, out type, out byteOffset, out byteLength, out rerr);
+			CheckError(rerr);
+			Assert.AreEqual(JSArrayBufferViewType.Float64Array, type);
+			Assert.AreEqual(8, byteOffset);
+			Assert.AreEqual(16, byteLength);
+			var doubles = new double[2];
+			Marshal.Copy(data, doubles, 0, 2);
+			Assert.AreEqual(new double[] { 2, 3 }, doubles);
+			Value.Release(context, Value.AsValue(view));
+		}
+
+		Context.Release(context);
+		handle.Free();
+	}
+
+	[Test]
+	public void OwnedArrayBuffers()
+	{
+		var testName = "OwnedArrayBuffers";
+		var context = Context.Create(_callbackFinalizer, _externalFinalizer);
+
+		var len = 64;
+		var buf = new byte[len];
+		var handle = GCHandle.Alloc(buf, GCHandleType.Pinned);
+		var arrayBuffer = Value.CreateOwnedArrayBuffer(context, handle.AddrOfPinnedObject(), len, GCHandle.ToIntPtr(handle));
+
+		JSRuntimeError rerr;
+		Assert.AreEqual(handle.AddrOfPinnedObject(), Value.GetArrayBufferData(context, arrayBuffer, out rerr));
+		CheckError(rerr);
+		Assert.AreEqual(len, Value.GetArrayBufferByteLength(context, arrayBuffer, out rerr));
+		CheckError(rerr);
+
+		var fill = AsFunction(Eval(context, testName, "(function(buf) { var x = new Uint8Array(buf); for (var i = 0; i < x.length; ++i) x[i] = i; })"));
+		JSScriptException err;
+		var result = Value.CallCreate(context, fill, default(JSObject), new JSValue[] { Value.AsValue(arrayBuffer) }, 1, out err);
+		CheckError(context, err);
+		for (int i = 0; i < len; ++i)
+			Assert.AreEqual((byte)i, buf[i]);
+
+		Value.Release(context, result);
+		Value.Release(context, Value.AsValue(fill));
+		Value.Release(context, Value.AsValue(arrayBuffer));
+		Context.Release(context);
+
+		// Returning a pooled isolate collects the buffer
+		JSRuntimeError perr;
+		var pool = IsolatePool.Create(1, null, 0, JSArrayBufferAllocatorType.Malloc, out perr);
+		CheckError(perr);
+		context = IsolatePool.CreateContext(pool, _callbackFinalizer, _countingExternalFinalizer);
+		JSHeapStatistics before;
+		Isolate.GetHeapStatistics(Context.GetIsolate(context), out before);
+		handle = GCHandle.Alloc(buf, GCHandleType.Pinned);
+		arrayBuffer = Value.CreateOwnedArrayBuffer(context, handle.AddrOfPinnedObject(), len, GCHandle.ToIntPtr(handle));
+		JSHeapStatistics during;
+		Isolate.GetHeapStatistics(Context.GetIsolate(context), out during);
+		Assert.AreEqual(before.ExternalMemory + len, during.ExternalMemory);
+		Value.Release(context, Value.AsValue(arrayBuffer));
+		_externalsFinalized = 0;
+		Context.Release(context);
+		Assert.AreEqual(1, _externalsFinalized);
+
+		context = IsolatePool.CreateContext(pool, null, null);
+		JSHeapStatistics after;
+		Isolate.GetHeapStatistics(Context.GetIsolate(context), out after);
+		Assert.AreEqual(before.ExternalMemory, after.ExternalMemory);
+		Context.Release(context);
+		IsolatePool.Release(pool);
+	}
+
+	static int _externalsFinalized;
+
+	static void CountFinalizedExternal(IntPtr external)
+	{
+		++_externalsFinalized;
+		FinalizeExternal(external);
+	}
+
+	readonly JSExternalFinalizer _countingExternalFinalizer = CountFinalizedExternal;
+
+	[Test]
+	public void ArrayBufferAllocators()
+	{
+		var testName = "ArrayBufferAllocators";
+		foreach (var allocatorType in new JSArrayBufferAllocatorType[] { JSArrayBufferAllocatorType.Malloc, JSArrayBufferAllocatorType.Pooled })
+		{
+			var context = Context.CreateWithArrayBufferAllocator(null, null, allocatorType);
+
+			var buf = AsObject(Eval(context, testName, "var bufs = []; for (var i = 0; i < 1000; ++i) bufs.push(new ArrayBuffer(i)); var last = new Uint8Array(bufs[999]); last[998] = 42; bufs[999]"));
+			JSRuntimeError rerr;
+			var ptr = Value.GetArrayBufferData(context, buf, out rerr);
+			CheckError(rerr);
+			Assert.AreEqual(42, Marshal.ReadByte(ptr, 998));
+			Assert.AreEqual(0, Marshal.ReadByte(ptr, 0));
+
+			JSArrayBufferAllocatorStatistics statistics;
+			Context.GetArrayBufferAllocatorStatistics(context, out statistics);
+			Assert.GreaterOrEqual(statistics.LiveBytes, 999 * 1000 / 2);
+			Assert.GreaterOrEqual(statistics.PeakBytes, statistics.LiveBytes);
+			if (allocatorType == JSArrayBufferAllocatorType.Pooled)
+				Assert.Greater(statistics.PoolMisses, 0);
+			else
+				Assert.AreEqual(0, statistics.PoolHits + statistics.PoolMisses);
+
+			Value.Release(context, Value.AsValue(buf));
+			Context.Release(context);
+		}
+	}
+
+	[Test]
+	public void ExternalStrings()
+	{
+		var testName = "ExternalStrings";
+		var context = Context.Create(_callbackFinalizer, _externalFinalizer);
+		var concat = AsFunction(Eval(context, testName, "(function(a, b) { return a + '|' + b + '|' + a.length; })"));
+
+		var chars = "hello, \u00e6\u00f8\u00e5 \u4e16\u754c".ToCharArray();
+		var charsHandle = GCHandle.Alloc(chars, GCHandleType.Pinned);
+		JSRuntimeError rerr;
+		var twoByte = Value.CreateExternalString(context, charsHandle.AddrOfPinnedObject(), chars.Length, GCHandle.ToIntPtr(charsHandle), out rerr);
+		CheckError(rerr);
+
+		var bytes = new byte[] { (byte)'c', (byte)'a', (byte)'f', 0xe9 };
+		var bytesHandle = GCHandle.Alloc(bytes, GCHandleType.Pinned);
+		var oneByte = Value.CreateExternalOneByteString(context, bytesHandle.AddrOfPinnedObject(), bytes.Length, GCHandle.ToIntPtr(bytesHandle), out rerr);
+		CheckError(rerr);
+
+		Assert.AreEqual(chars.Length, Value.Length(context, twoByte));
+		Assert.AreEqual(bytes.Length, Value.Length(context, oneByte));
+
+		JSScriptException err;
+		var result = Value.CallCreate(context, concat, default(JSObject), new JSValue[] { Value.AsValue(twoByte), Value.AsValue(oneByte) }, 2, out err);
+		CheckError(context, err);
+		Assert.AreEqual(new string(chars) + "|caf\u00e9|" + chars.Length, AsString(context, result));
+
+		Value.Release(context, result);
+		Value.Release(context, Value.AsValue(oneByte));
+		Value.Release(context, Value.AsValue(twoByte));
+		Value.Release(context, Value.AsValue(concat));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void Utf8AndOneByteStrings()
+	{
+		var testName = "Utf8AndOneByteStrings";
+		var context = Context.Create(null, null);
+		var text = "na\u00efve \u4e16\u754c \ud83d\ude00";
+
+		var utf8 = Encoding.UTF8.GetBytes(text);
+		JSRuntimeError rerr;
+		var fromUtf8 = Value.CreateStringFromUtf8(context, utf8, utf8.Length, out rerr);
+		CheckError(rerr);
+		Assert.AreEqual(text, Value.ToString(context, fromUtf8));
+
+		var written = new byte[utf8.Length];
+		Assert.AreEqual(utf8.Length, Value.WriteUtf8(context, fromUtf8, written, written.Length));
+		Assert.AreEqual(utf8, written);
+
+		// Truncated writes still report the full length and never split a character
+		var small = new byte[4];
+		Assert.AreEqual(utf8.Length, Value.WriteUtf8(context, fromUtf8, small, small.Length));
+		Assert.AreEqual((byte)'n', small[0]);
+		Assert.AreEqual((byte)'a', small[1]);
+		Assert.AreEqual(0xc3, small[2]);
+		Assert.AreEqual(0xaf, small[3]);
+
+		// A negative capacity writes nothing
+		var untouched = new byte[4];
+		Assert.AreEqual(utf8.Length, Value.WriteUtf8(context, fromUtf8, untouched, -1));
+		Assert.AreEqual(new byte[4], untouched);
+
+		var latin1 = new byte[] { (byte)'c', (byte)'a', (byte)'f', 0xe9 };
+		var fromOneByte = Value.CreateStringFromOneByte(context, latin1, latin1.Length, out rerr);
+		CheckError(rerr);
+		Assert.AreEqual("caf\u00e9", Value.ToString(context, fromOneByte));
+
+		var oneByte = new byte[latin1.Length];
+		Assert.AreEqual(latin1.Length, Value.WriteOneByte(context, fromOneByte, oneByte, oneByte.Length));
+		Assert.AreEqual(latin1, oneByte);
+		Assert.AreEqual(latin1.Length, Value.WriteOneByte(context, fromOneByte, untouched, -1));
+		Assert.AreEqual(new byte[4], untouched);
+
+		var upper = AsFunction(Eval(context, testName, "(function(s) { return s.toUpperCase(); })"));
+		JSScriptException err;
+		var result = Value.CallCreate(context, upper, default(JSObject), new JSValue[] { Value.AsValue(fromOneByte) }, 1, out err);
+		CheckError(context, err);
+		Assert.AreEqual("CAF\u00c9", AsString(context, result));
+
+		Value.Release(context, result);
+		Value.Release(context, Value.AsValue(upper));
+		Value.Release(context, Value.AsValue(fromOneByte));
+		Value.Release(context, Value.AsValue(fromUtf8));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ReadStringBuffer()
+	{
+		var testName = "ReadStringBuffer";
+		var context = Context.Create(null, null);
+
+		var latin1 = AsObject(Eval(context, testName, "({ s: 'caf\u00e9 au lait' })"));
+		JSScriptException err;
+		JSRuntimeError rerr;
+		var key = AsJSString(context, "s");
+		var oneByte = Value.AsString(Value.CopyProperty(context, latin1, key, out err), out rerr);
+		CheckError(context, err);
+		CheckError(rerr);
+
+		bool isOneByte;
+		var small = new char[4];
+		Assert.AreEqual(12, Value.Read(context, oneByte, small, small.Length, out isOneByte));
+		Assert.IsTrue(isOneByte);
+		Assert.AreEqual("caf\u00e9", new string(small));
+
+		// A negative capacity writes nothing
+		var untouched = new char[4];
+		Assert.AreEqual(12, Value.Read(context, oneByte, untouched, -1, out isOneByte));
+		Assert.AreEqual(new string('\0', 4), new string(untouched));
+
+		var large = new char[12];
+		Assert.AreEqual(12, Value.Read(context, oneByte, large, large.Length, out isOneByte));
+		Assert.AreEqual("caf\u00e9 au lait", new string(large));
+
+		var text = "\u4e16\u754c" + new string('x', 1000);
+		var twoByte = AsJSString(context, text);
+		Assert.AreEqual(text.Length, Value.Read(context, twoByte, large, large.Length, out isOneByte));
+		Assert.IsFalse(isOneByte);
+		Assert.AreEqual(text, Value.ToString(context, twoByte));
+
+		Value.Release(context, Value.AsValue(twoByte));
+		Value.Release(context, Value.AsValue(oneByte));
+		Value.Release(context, Value.AsValue(key));
+		Value.Release(context, Value.AsValue(latin1));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void InternedStrings()
+	{
+		var testName = "InternedStrings";
+		var context = Context.Create(null, null);
+		var obj = AsObject(Eval(context, testName, "({ id: 42, children: [] })"));
+
+		JSRuntimeError rerr;
+		var id = Value.GetInternedString(context, "id", 2, out rerr);
+		CheckError(rerr);
+		Assert.AreEqual(id, Value.GetInternedString(context, "id", 2, out rerr));
+		Assert.AreEqual(id, Value.GetInternedString(context, "id", -1, out rerr));
+		CheckError(rerr);
+		Assert.AreEqual(default(JSString), Value.GetInternedString(context, "id", -2, out rerr));
+		Assert.AreEqual(JSRuntimeError.RangeError, rerr);
+		var children = Value.GetInternedString(context, "children", 8, out rerr);
+		Assert.AreNotEqual(id, children);
+		Assert.AreEqual("children", Value.ToString(context, children));
+
+		JSScriptException err;
+		var value = Value.CopyProperty(context, obj, id, out err);
+		CheckError(context, err);
+		Assert.AreEqual(42, AsInt(value));
+
+		var one = Value.CreateInt(1);
+		Value.SetProperty(context, obj, children, one, out err);
+		CheckError(context, err);
+		Value.Release(context, one);
+		var result = Value.CopyProperty(context, obj, children, out err);
+		CheckError(context, err);
+		Assert.AreEqual(1, AsInt(result));
+
+		// Interned keys are owned by the context, so they are not released here
+		Value.Release(context, result);
+		Value.Release(context, value);
+		Value.Release(context, Value.AsValue(obj));
+		Context.Release(context);
+	}
+
+	[Test]
+	public void ScriptExceptionFields()
+	{
+		var testName = "ScriptExceptionFields";
+		var context = Context.Create(null, null);
+		var jsName = AsJSString(context, testName);
+		var jsCode = AsJSString(context, "function thrower() {\n  var x = 1;\n  throw new Error('boom');\n}\nthrower();");
+		JSScriptException err;
+		var result = Context.EvaluateCreate(context, jsName, jsCode, out err);
+		Assert.AreEqual(JSType.Null, Value.GetType(result));
+		Assert.AreNotEqual(default(JSScriptException), err);
+
+		// Fields are computed on first access, so run more script before reading them
+		Value.Release(context, Eval(context, testName, "[1, 2, 3].map(function(x) { return x * 2; })"));
+
+		Assert.AreEqual("Uncaught Error: boom", Value.ToString(context, ScriptException.GetMessage(err)));
+		Assert.AreEqual(testName, Value.ToString(context, ScriptException.GetFileName(err)));
+		Assert.AreEqual(3, ScriptException.GetLineNumber(err));
+		Assert.AreEqual("  throw new Error('boom');", Value.ToString(context, ScriptException.GetSourceLine(err)));
+		Assert.IsTrue(Value.ToString(context, ScriptException.GetStackTrace(err)).Contains("at thrower"));
+		// Repeated access returns the same value
+		Assert.AreEqual(ScriptException.GetMessage(err), ScriptException.GetMessage(err));
+		var exception = AsObject(ScriptException.GetException(err));
+		Assert.AreEqual(exception, AsObject(ScriptException.GetException(err)));
+
+		ScriptException.Release(context, err);
+
+		// The exception keeps its context alive until it is released
+		Value.Release(context, Context.EvaluateCreate(context, jsName, jsCode, out err));
+		Value.Release(context, Value.AsValue(jsCode));
+		Value.Release(context, Value.AsValue(jsName));
+		Context.Release(context);
+		Assert.AreEqual(3, ScriptException.GetLineNumber(err));
+		ScriptException.Release(context, err);
+	}
+
+	[Test]
+	public void ContextScopes()
+	{
+		var testName = "ContextScopes";
+		var context = Context.Create(null, null);
+		var other = Context.Create(null, null);
+
+		Context.EnterScope(context);
+		var obj = AsObject(Eval(context, testName, "({ x: 1 })"));
+		var key = AsJSString(context, "x");
+		JSScriptException err;
+		for (int i = 0; i < 10; ++i)
+		{
+			var value = Value.CreateInt(i);
+			Value.SetProperty(context, obj, key, value, out err);
+			CheckError(context, err);
+			Value.Release(context, value);
+		}
+
+		// Calls on another context still work while a scope is entered
+		Context.EnterScope(other);
+		var otherResult = Eval(other, testName, "1 + 2");
+		Assert.AreEqual(3, AsInt(otherResult));
+		Value.Release(other, otherResult);
+		var contextResult = Eval(context, testName, "2 + 3");
+		Assert.AreEqual(5, AsInt(contextResult));
+		Value.Release(context, contextResult);
+		JSRuntimeError rerr;
+		Context.ExitScope(other, out rerr);
+		CheckError(rerr);
+
+		// Only the innermost scope can be exited
+		Context.ExitScope(other, out rerr);
+		Assert.AreEqual(JSRuntimeError.WrongContext, rerr);
+
+		// Releasing inside and outside a scope
+		var result = Value.CopyProperty(context, obj, key, out err);
+		CheckError(context, err);
+		Assert.AreEqual(9, AsInt(result));
+		Value.Release(context, result);
+		Context.ExitScope(context, out rerr);
+		CheckError(rerr);
+
+		Value.Release(context, Value.AsValue(key));
+		Value.Release(context, Value.AsValue(obj));
+		Context.Release(other);
+		Context.Release(context);
+	}
+
+	[Test]
+	public void IsolatePools()
+	{
+		var testName = "IsolatePools";
+		JSRuntimeError err;
+
+		var bootstrap = "var bootstrapped = { answer: 40 + 2 };";
+		var snapshot = Snapshot.Create(bootstrap, bootstrap.Length, out err);
+		CheckError(err);
+		var blob = Snapshot.ToArray(snapshot);
+		Snapshot.Release(snapshot);
+
+		var pool = IsolatePool.Create(1, blob, blob.Length, JSArrayBufferAllocatorType.Malloc, out err);
+		CheckError(err);
+		JSIsolatePoolStatistics statistics;
+		IsolatePool.GetStatistics(pool, out statistics);
+		Assert.AreEqual(1, statistics.Idle);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			var context = IsolatePool.CreateContext(pool, _callbackFinalizer, _externalFinalizer);
+			var answer = Eval(context, testName, "bootstrapped.answer");
+			Assert.AreEqual(42, AsInt(answer));
+			// Globals don't leak from one context to the next
+			var type = Eval(context, testName, "typeof leaked");
+			Assert.AreEqual("undefined", AsString(context, type));
+			Value.Release(context, Eval(context, testName, "var leaked = {};"));
+			Value.Release(context, type);
+			Value.Release(context, answer);
+			Context.Release(context);
+		}
+
+		// An isolate still used by another context isn't handed out again
+		var pooled = IsolatePool.CreateContext(pool, null, null);
+		var tenant = Isolate.CreateContext(Context.GetIsolate(pooled), null, null);
+		Context.Release(pooled);
+		IsolatePool.GetStatistics(pool, out statistics);
+		Assert.AreEqual(0, statistics.Idle);
+		Context.Release(tenant);
+
+		// Two at once: the second one doesn't find an idle isolate
+		var first = IsolatePool.CreateContext(pool, null, null);
+		var second = IsolatePool.CreateContext(pool, null, null);
+		IsolatePool.Release(pool);
+		var sum = Eval(second, testName, "1 + 2");
+		Assert.AreEqual(3, AsInt(sum));
+		Value.Release(second, sum);
+		Context.Release(first);
+		Context.Release(second);
+
+		Assert.AreEqual(default(JSIsolatePool), IsolatePool.Create(-1, null, 0, JSArrayBufferAllocatorType.Malloc, out err));
+		Assert.AreEqual(JSRuntimeError.RangeError, err);
+		var staleBlob = (byte[])blob.Clone();
+		staleBlob[0] ^= 0xff;
+		Assert.AreEqual(default(JSIsolatePool), IsolatePool.Create(1, staleBlob, staleBlob.Length, JSArrayBufferAllocatorType.Malloc, out err));
+		Assert.AreEqual(JSRuntimeError.SnapshotError, err);
+	}
+
+	[Test]
+	public void SharedIsolates()
+	{
+		var testName = "SharedIsolates";
+		JSRuntimeError rerr;
+		var isolate = Isolate.Create(null, 0, JSArrayBufferAllocatorType.Malloc, out rerr);
+		CheckError(rerr);
+		var first = Isolate.CreateContext(isolate, _callbackFinalizer, _externalFinalizer);
+		var second = Isolate.CreateContext(isolate, _callbackFinalizer, _externalFinalizer);
+		Isolate.Release(isolate);
+		Assert.AreEqual(isolate, Context.GetIsolate(first));
+		Assert.AreEqual(isolate, Context.GetIsolate(second));
+
+		// Separate globals
+		Value.Release(first, Eval(first, testName, "var onlyInFirst = 1;"));
+		var type = Eval(second, testName, "typeof onlyInFirst");
+		Assert.AreEqual("undefined", AsString(second, type));
+		Value.Release(second, type);
+
+		// Values and scripts move between contexts of the same isolate
+		var obj = AsObject(Eval(first, testName, "({ x: 21 })"));
+		var fun = AsFunction(Eval(second, testName, "(function(o) { return o.x * 2; })"));
+		JSScriptException err;
+		var result = Value.CallCreate(second, fun, default(JSObject), new JSValue[] { Value.AsValue(obj) }, 1, out err);
+		CheckError(second, err);
+		Assert.AreEqual(42, AsInt(result));
+		Value.Release(second, result);
+
+		var jsName = AsJSString(first, testName);
+		var jsCode = AsJSString(first, "typeof onlyInFirst");
+		var script = Script.Compile(first, jsName, jsCode, out err);
+		CheckError(first, err);
+		result = Script.Run(second, script, out err);
+		CheckError(second, err);
+		Assert.AreEqual("undefined", AsString(second, result));
+		Value.Release(second, result);
+		Script.Release(first, script);
+
+		// A callback kept by another context runs in its own context, and
+		// throws instead once that is released
+		var cb = CreateCallback(first, (cxt, args) => Value.CreateInt(AsInt(args[0]) + 1));
+		var hold = AsFunction(Eval(second, testName, "(function(f) { this.held = f; })"));
+		result = Value.CallCreate(second, hold, default(JSObject), new JSValue[] { Value.AsValue(cb) }, 1, out err);
+		CheckError(second, err);
+		Value.Release(second, result);
+		result = Eval(second, testName, "held(41)");
+		Assert.AreEqual(42, AsInt(result));
+		Value.Release(second, result);
+
+		Value.Release(first, Value.AsValue(cb));
+		Value.Release(first, Value.AsValue(jsCode));
+		Value.Release(first, Value.AsValue(jsName));
+		Value.Release(first, Value.AsValue(obj));
+		Context.Release(first);
+
+		result = Eval(second, testName, "held('x')", out err);
+		Assert.AreEqual(default(JSValue), result);
+		Assert.AreNotEqual(default(JSScriptException), err);
+		ScriptException.Release(second, err);
+
+		Value.Release(second, Value.AsValue(hold));
+		Value.Release(second, Value.AsValue(fun));
+		Context.Release(second);
+	}
+
+	// Stress test: grows an array until the heap limit policy terminates the
+	// script. Without the policy V8 would abort the process instead.
+	[Test]
+	public void HeapLimitPolicy()
+	{
+		var testName = "HeapLimitPolicy";
+		var options = new JSIsolateOptions
+		{
+			MaxOldSpaceSizeMB = 32,
+			AllocatorType = JSArrayBufferAllocatorType.Malloc,
+			HeapLimitPolicy = JSHeapLimitPolicy.TerminateExecution,
+			HeapLimitPercent = 80,
+		};
+		JSRuntimeError rerr;
+		var context = Context.CreateWithOptions(_callbackFinalizer, _externalFinalizer, ref options, out rerr);
+		CheckError(rerr);
+
+		JSScriptException err;
+		var result = Eval(context, testName, "(function() { var a = []; while (true) a.push({ x: a.length }); })()", out err);
+		Assert.AreEqual(default(JSValue), result);
+		Assert.AreNotEqual(default(JSScriptException), err);
+		ScriptException.Release(context, err);
+
+		JSHeapStatistics stats;
+		Isolate.GetHeapStatistics(Context.GetIsolate(context), out stats);
+		Assert.IsTrue(stats.HeapLimitTerminations >= 1);
+		Assert.IsTrue(stats.UsedHeapSize <= stats.HeapSizeLimit);
+
+		// The array is garbage now, so the context can run scripts again
+		result = Eval(context, testName, "42");
+		Assert.AreEqual(42, AsInt(result));
+		Value.Release(context, result);
+		Context.Release(context);
+
+		options.HeapLimitPercent = 0;
+		context = Context.CreateWithOptions(_callbackFinalizer, _externalFinalizer, ref options, out rerr);
+		Assert.AreEqual(JSRuntimeError.RangeError, rerr);
+		Assert.AreEqual(default(JSContext), context);
+	}
+
+	[Test]
+	public void PlatformInitialization()
+	{
+		var options = new JSPlatformOptions { WorkerThreads = 2 };
+		// Other tests may already have initialized V8 with default options
+		JSRuntimeError rerr;
+		Platform.Initialize(ref options, out rerr);
+		JSPlatformOptions applied;
+		Assert.IsTrue(Platform.GetOptions(out applied));
+		if (rerr == JSRuntimeError.NoError)
+			Assert.AreEqual(2, applied.WorkerThreads);
+		else
+			Assert.AreEqual(JSRuntimeError.AlreadyInitialized, rerr);
+
+		// Only once
+		options.WorkerThreads = 3;
+		Platform.Initialize(ref options, out rerr);
+		Assert.AreEqual(JSRuntimeError.AlreadyInitialized, rerr);
+		JSPlatformOptions unchanged;
+		Assert.IsTrue(Platform.GetOptions(out unchanged));
+		Assert.AreEqual(applied.WorkerThreads, unchanged.WorkerThreads);
+
+		var contexts = new JSContext[4];
+		var threads = new System.Threading.Thread[contexts.Length];
+		for (int i = 0; i < threads.Length; ++i)
+		{
+			int index = i;
+			threads[i] = new System.Threading.Thread(() =>
+			{
+				contexts[index] = Context.Create(_callbackFinalizer, _externalFinalizer);
+			});
+			threads[i].Start();
+		}
+		foreach (var thread in threads)
+			thread.Join();
+
+		Assert.IsFalse(Platform.Shutdown());
+		foreach (var context in contexts)
+		{
+			var result = Eval(context, "PlatformInitialization", "6 * 7");
+			Assert.AreEqual(42, AsInt(result));
+			Value.Release(context, result);
+			Context.Release(context);
+		}
+	}
 }